@@ -1,17 +1,117 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "chip8/memory.h"
 
 namespace Chip8
 {
+    // Beeps while the guest's sound timer runs, with a square wave, or with
+    // the XO-CHIP 1-bit pattern at the rate its pitch register asks for.
+    //
+    // The emulation thread switches the beeper on and off with play() and
+    // pause(), and changes what it plays with setPattern(). Every change is
+    // stamped with guest time, counted in samples from the frames passed to
+    // beginFrame(), and goes through a lock-free single producer, single
+    // consumer ring to the SDL audio callback. The callback places each
+    // change at its exact sample, so beeps keep their length however
+    // unevenly frames are paced. A change that arrives after its sample has
+    // been played is played at once and every later change is delayed by
+    // as much, so the delay settles at what the pacing jitter needs, which
+    // is less than one buffer. Changes more than a buffer ahead of the
+    // device are played at once too.
+    //
+    // Both sounds are one period of 128 levels, the square wave or the
+    // pattern's bits, that the callback resamples to the device rate in
+    // batches.
+    //
+    // Neither thread ever waits for the other. If the ring is full the
+    // newest change is retried on the next frame.
     class Audio
     {
-    private:
-        
     public:
+        static const int SAMPLE_RATE = 44100;
+        static const uint16_t BUFFER_SAMPLES = 512;
+        static const int FREQUENCY = 440;
+        static const int16_t AMPLITUDE = 4096;
+        static const size_t EVENTS = 64;
+        static const int LEVELS = PATTERN_SIZE * 8;
+
         Audio();
         ~Audio();
 
-        void play();
-        void pause();
-        bool isPlaying();
+        Audio(const Audio&) = delete;
+        Audio& operator=(const Audio&) = delete;
+
+        // Opens an SDL audio device, which works with the dummy and disk
+        // drivers as well. SDL's audio subsystem must be initialized. Call
+        // before the emulation thread starts. Without a device the beeper
+        // stays silent.
+        bool open(char const* device = nullptr);
+        void close();
+
+        // Emulation thread. offset is how far into the current frame the
+        // change happened, from 0 to 1.
+        void beginFrame();
+        void play(float offset = 0.0f);
+        void pause(float offset = 0.0f);
+        bool isPlaying() const { return _playing; }
+
+        // Plays the PATTERN_SIZE bytes of an XO-CHIP pattern, most
+        // significant bit first, at 4000 * 2 ^ ((pitch - 64) / 48) bits per
+        // second, or the square wave if pattern is nullptr.
+        void setPattern(const uint8_t* pattern, uint8_t pitch, float offset = 0.0f);
+        bool playsPattern(const uint8_t* pattern, uint8_t pitch) const;
+
+        // Audio thread. Fills the samples with the sound for the changes
+        // queued so far. Called by the SDL callback.
+        void mix(int16_t* samples, int count);
+
+        int getSampleRate() const { return _sampleRate; }
+
+    private:
+        struct Event {
+            // guest time in samples
+            uint64_t time;
+            // one period of the levels is 2^32
+            uint32_t step;
+            bool on;
+            bool hasPattern;
+            uint8_t pattern[PATTERN_SIZE];
+        };
+
+        static void callback(void* userdata, Uint8* stream, int length);
+
+        void push(float offset);
+        void apply(const Event& event);
+
+        SDL_AudioDeviceID _device;
+        int _sampleRate;
+
+        // written by the emulation thread only
+        uint64_t _frame;
+        bool _playing;
+        bool _pending;
+        bool _hasPattern;
+        uint8_t _pitch;
+        uint8_t _pattern[PATTERN_SIZE];
+
+        Event _events[EVENTS];
+        std::atomic<size_t> _head { 0 };
+        std::atomic<size_t> _tail { 0 };
+
+        // written by the audio thread only
+        uint64_t _clock;
+        // device sample of guest time 0
+        int64_t _offset;
+        bool _on;
+        uint32_t _phase;
+        uint32_t _step;
+        int16_t _levels[LEVELS];
     };
+
+    // Writes 16-bit mono PCM samples as a WAV file.
+    bool writeWav(char const* filename, const std::vector<int16_t>& samples, int sampleRate);
 } // namespace Chip8
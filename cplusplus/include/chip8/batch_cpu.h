@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "chip8/memory.h"
+#include "chip8/timing.h"
+#include "chip8/quirks.h"
+
+namespace Chip8 {
+    class CPU;
+    class Registers;
+    class Display;
+    class Keyboard;
+
+    // Runs many machines ("lanes") in lockstep, usually all on the same ROM.
+    // V0-VF, I, PC, the timers and the cycle budgets of every lane are kept
+    // as one array per register, and each step runs one instruction for all
+    // lanes that are at the same PC, with loops over the lanes that are
+    // compiled to SSE2 and AVX2. Lanes that took another branch form their
+    // own group and are stepped after it.
+    //
+    // Instructions without a kernel (drawing, subroutines, memory, input,
+    // random numbers) run on the lane's own CPU, so every lane behaves exactly
+    // like a scalar CPU would. A group too small to be worth a vector step
+    // finishes its frame on the scalar CPUs as well.
+    class BatchCPU {
+        public:
+            explicit BatchCPU(size_t lanes);
+            ~BatchCPU();
+
+            BatchCPU(const BatchCPU&) = delete;
+            BatchCPU& operator=(const BatchCPU&) = delete;
+
+            // Loads the program into every lane, reading the file once. Set
+            // the quirks first, they decide how much memory there is. All
+            // lanes have the same memory, so they fail alike.
+            RomError loadROM(char const* filename);
+            RomError loadROM(const uint8_t* data, size_t length);
+
+            // Runs one 60 Hz frame on every lane.
+            void tick();
+
+            size_t getSize() const { return _lanes.size(); }
+            Memory& getMemory(size_t lane);
+            Display& getDisplay(size_t lane);
+            Keyboard& getKeyboard(size_t lane);
+            void seedRandom(size_t lane, unsigned int seed);
+            void setTiming(const Timing& timing);
+            void setQuirks(const Quirks& quirks);
+
+            uint8_t getRegister(size_t lane, uint8_t index) const { return _v[index * _stride + lane]; }
+            uint16_t getPc(size_t lane) const { return _pc[lane]; }
+            uint16_t getIndex(size_t lane) const { return _index[lane]; }
+            uint8_t getDelayTimer(size_t lane) const { return _delayTimer[lane]; }
+            uint8_t getSoundTimer(size_t lane) const { return _soundTimer[lane]; }
+            uint64_t getInstructionCount(size_t lane) const { return _instructionCount[lane]; }
+            uint64_t getInstructionCount() const;
+
+        private:
+            // Memory is tracked in 16-byte chunks. A lane whose chunk has been
+            // written since the ROM was loaded may hold different code there.
+            static const uint16_t CHUNK_SIZE = 16;
+            static const uint16_t CHUNKS = XO_RAM_SIZE / CHUNK_SIZE;
+
+            class WriteTracker : public MemoryObserver {
+                public:
+                    WriteTracker(BatchCPU& batch, size_t lane) : _batch(batch), _lane(lane) {}
+                    void onMemoryWritten(uint16_t addr, uint16_t length) override;
+
+                private:
+                    BatchCPU& _batch;
+                    size_t _lane;
+            };
+
+            struct Lane {
+                std::shared_ptr<Memory> memory;
+                std::shared_ptr<Registers> registers;
+                std::unique_ptr<CPU> cpu;
+                std::shared_ptr<Display> display;
+                std::shared_ptr<Keyboard> keyboard;
+                std::unique_ptr<WriteTracker> tracker;
+            };
+
+            void markWritten(size_t lane, uint16_t addr, uint16_t length);
+            void clearWritten();
+            bool isWritten(size_t lane, uint16_t addr) const;
+            size_t chunkOf(uint16_t addr) const { return (addr & (_quirks.memorySize - 1)) / CHUNK_SIZE; }
+
+            void dropDifferentCode(size_t leader, uint16_t opcode);
+            void stepScalar(size_t lane);
+            void finishScalar(size_t lane);
+            void loadLane(size_t lane);
+            void storeLane(size_t lane);
+
+            std::vector<Lane> _lanes;
+            size_t _stride;
+
+            // one row of _stride lanes per register
+            std::vector<uint8_t> _v;
+            std::vector<uint16_t> _pc;
+            std::vector<uint16_t> _index;
+            std::vector<uint8_t> _delayTimer;
+            std::vector<uint8_t> _soundTimer;
+            std::vector<int32_t> _microSeconds;
+            std::vector<uint64_t> _instructionCount;
+            // lanes that still have budget left in the current frame
+            std::vector<uint8_t> _running;
+            // lanes taking part in the current step (0x00 or 0xFF)
+            std::vector<uint8_t> _mask;
+            // per lane result of the condition of a skip instruction
+            std::vector<uint8_t> _skip;
+            Timing _timing;
+            Quirks _quirks;
+
+            std::vector<uint64_t> _written;
+            uint32_t _writtenLanes[CHUNKS];
+    };
+}
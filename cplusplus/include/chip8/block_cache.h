@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "chip8/decoder.h"
+#include "chip8/memory.h"
+
+namespace Chip8 {
+
+    // A straight line run of decoded instructions. Only the last instruction
+    // of a block may change the program counter or write to memory.
+    struct Block {
+        static const uint8_t MAX_LENGTH = 32;
+
+        uint16_t start;
+        uint16_t end;
+        uint8_t length;
+        bool valid;
+        uint8_t nextSuccessor;
+        // the blocks this one most recently continued into
+        Block* successors[2];
+        Instruction instructions[MAX_LENGTH];
+    };
+
+    // Basic blocks indexed by their start address. Block objects are never
+    // freed while the cache lives, so successor links stay safe to follow;
+    // a write into a block only marks it invalid and it is rebuilt in place
+    // on the next lookup.
+    class BlockCache : public MemoryObserver {
+        public:
+            static const uint16_t SLOTS = RAM_SIZE / 2;
+
+            // Returns the block starting at pc, or nullptr if pc is odd or
+            // outside of memory.
+            Block* lookup(uint16_t pc, Memory& memory) {
+                if((pc & 1) != 0 || pc >= RAM_SIZE) {
+                    return nullptr;
+                }
+                auto& block = _blocks[pc >> 1];
+                if(block == nullptr || !block->valid) {
+                    build(pc, memory);
+                }
+                return block.get();
+            }
+
+            // Follows the chain from a finished block to the block at pc.
+            Block* next(Block* block, uint16_t pc, Memory& memory) {
+                for(auto successor : block->successors) {
+                    if(successor != nullptr && successor->valid && successor->start == pc) {
+                        return successor;
+                    }
+                }
+                auto successor = lookup(pc, memory);
+                if(successor != nullptr) {
+                    block->successors[block->nextSuccessor] = successor;
+                    block->nextSuccessor ^= 1;
+                }
+                return successor;
+            }
+
+            void invalidate();
+            void onMemoryWritten(uint16_t addr, uint16_t length) override;
+
+        private:
+            void build(uint16_t pc, Memory& memory);
+
+            std::unique_ptr<Block> _blocks[SLOTS];
+    };
+}
@@ -1,87 +1,204 @@
 #pragma once
 #include <memory>
-#include <random>
 #include <chrono>
+#include <utility>
 #include "chip8/memory.h"
+#include "chip8/decoder.h"
+#include "chip8/display.h"
+#include "chip8/timing.h"
+#include "chip8/quirks.h"
+#include "chip8/instruction_cache.h"
+#include "chip8/block_cache.h"
+#include "chip8/recompiler.h"
 
 namespace Chip8 {
     class Memory;
     class Registers;
-    class Display;
     class Keyboard;
     class Audio;
 
+    // Everything the CPU keeps between instructions apart from memory and
+    // the V registers. What the interpreter touches on every instruction is
+    // packed into the first cache line.
+    struct alignas(64) CpuState {
+        uint16_t pc;
+        uint16_t index;
+        uint16_t stack[STACK_DEPTH];
+        uint8_t sp;
+        uint8_t delayTimer;
+        uint8_t soundTimer;
+        int32_t microSeconds;
+        // xorshift32 state for CXNN, never 0
+        uint32_t random;
+        // XO-CHIP audio, played instead of the plain beep once F002 has run
+        bool hasPattern;
+        uint8_t pitch;
+        uint8_t pattern[PATTERN_SIZE];
+    };
+
     class CPU {
         public:
             CPU(std::shared_ptr<Memory> memory,
                 std::shared_ptr<Registers> registers) 
-                : _pc(PROGRAM_START_ADDRESS)
-                , _index(0)
-                , _sp(0)
-                , _delayTimer(0)
-                , _soundTimer(0)
-                , _microSeconds(0)
+                : _state()
+                , _instructionCount(0)
+                , _soundWrittenAt(0)
+                , _blockExecution(true)
+                , _recompilation(false)
+                , _timing(Timing::vip())
                 , _memory(memory)
                 , _registers(registers)
-                , randGen(std::chrono::system_clock::now().time_since_epoch().count())
             { 
-                for (int i = 0; i < 16; i++)
-                {
-                    _stack[i] = 0;
-                } 
+                _state.pc = PROGRAM_START_ADDRESS;
+                _state.pitch = DEFAULT_PITCH;
+                // keeps the memory as it is, it may already hold a program
+                Quirks quirks;
+                quirks.memorySize = _memory->getSize();
+                setQuirks(quirks);
+                seedRandom(static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count()));
+                _memory->addObserver(&_instructionCache);
+                _memory->addObserver(&_blockCache);
+#if defined(CHIP8_JIT_ENABLED)
+                _memory->addObserver(&_recompiler);
+#endif
             }
 
+            ~CPU() {
+#if defined(CHIP8_JIT_ENABLED)
+                _memory->removeObserver(&_recompiler);
+#endif
+                _memory->removeObserver(&_blockCache);
+                _memory->removeObserver(&_instructionCache);
+            }
+
+            CPU(const CPU&) = delete;
+            CPU& operator=(const CPU&) = delete;
+
             void tick(
-                std::shared_ptr<Display> display,
-                std::shared_ptr<Keyboard> keyboard,
-                std::shared_ptr<Audio> audio);
+                const std::shared_ptr<Display>& display,
+                const std::shared_ptr<Keyboard>& keyboard,
+                const std::shared_ptr<Audio>& audio);
+
+            // Runs instructions until the budget left in the state is spent,
+            // without starting a new frame. Returns false if an invalid
+            // opcode was hit.
+            bool run(Display* display, Keyboard* keyboard);
 
             int emulateCycle(
-                std::shared_ptr<Display> display,
-                std::shared_ptr<Keyboard> keyboard);
+                const std::shared_ptr<Display>& display,
+                const std::shared_ptr<Keyboard>& keyboard);
+
+            uint16_t getPc() { return _state.pc; }
+            uint16_t getIndex() { return _state.index; }
+            void setDelayTimer(uint8_t value) { _state.delayTimer = value; }
+            uint8_t getDelayTimer() { return _state.delayTimer; }
+            uint8_t getSoundTimer() { return _state.soundTimer; }
+            uint64_t getInstructionCount() { return _instructionCount; }
+            const CpuState& getState() const { return _state; }
+            void setState(const CpuState& state) { _state = state; }
+
+            // When enabled, tick runs whole basic blocks instead of calling
+            // emulateCycle for every instruction.
+            void setBlockExecution(bool enabled) { _blockExecution = enabled; }
+
+            // When enabled, block execution runs hot code translated to
+            // x86-64. Has no effect unless built with CHIP8_ENABLE_JIT.
+            void setRecompilation(bool enabled) { _recompilation = enabled; }
 
-            uint16_t getPc() { return _pc; }
-            uint16_t getIndex() { return _index; }
-            void setDelayTimer(uint8_t value) { _delayTimer = value; }
-            uint8_t getDelayTimer() { return _delayTimer; }
-            uint8_t getSoundTimer() { return _soundTimer; }
+            void seedRandom(unsigned int seed) {
+                // spreads small seeds over all bits, xorshift gets stuck at 0
+                _state.random = seed * 2654435761u ^ 0x9E3779B9u;
+                if(_state.random == 0) {
+                    _state.random = 1;
+                }
+            }
+
+            // Switches to the code specialized for these quirks, and sets
+            // the size of memory.
+            void setQuirks(const Quirks& quirks);
+            const Quirks& getQuirks() const { return _quirks; }
+
+            // Whether DXYN clips sprites at the edge of the screen, like the
+            // COSMAC VIP, or wraps them around.
+            void setSpriteEdge(SpriteEdge edge) {
+                auto quirks = _quirks;
+                quirks.spriteEdge = edge;
+                setQuirks(quirks);
+            }
+
+            // How many instructions tick runs per frame.
+            void setTiming(const Timing& timing);
+            const Timing& getTiming() const { return _timing; }
 
         private:
-            uint16_t getOpcode();
+            friend struct Snapshot;
+            friend class SnapshotStore;
 
+            typedef bool (CPU::*RunFunction)(Display* display, Keyboard* keyboard);
+            typedef int (CPU::*ExecuteFunction)(const Instruction& instruction, Display* display, Keyboard* keyboard);
+
+            // Everything that runs instructions is instantiated once per
+            // combination of quirks (Quirks::getMask()).
+            template<size_t... QUIRKS>
+            void specialize(std::index_sequence<QUIRKS...>, uint8_t mask);
+
+            template<uint8_t QUIRKS>
+            bool runInstructions(Display* display, Keyboard* keyboard);
+            template<uint8_t QUIRKS>
+            bool runBlocks(Display* display, Keyboard* keyboard);
+            bool runRecompiled();
+            void updateSound(Audio& audio, float offset);
+
+            template<uint8_t QUIRKS>
             int execute(
-                uint16_t opcode,
-                std::shared_ptr<Display> display,
-                std::shared_ptr<Keyboard> keyboard);
+                const Instruction& instruction,
+                Display* display,
+                Keyboard* keyboard);
 
             int opJump(uint16_t nnn);
-            int opClearScreen(std::shared_ptr<Display> display);
+            int opClearScreen(Display* display);
+            int opScrollDown(uint8_t n, Display* display);
+            int opScrollRight(Display* display);
+            int opScrollLeft(Display* display);
+            int opSetResolution(bool hires, Display* display);
             int opReturn();
             int opReturnFromSubroutine();
             int opSetRegisterVxToNn(uint8_t x, uint8_t nn);
             int opAddNnToRegisterVx(uint8_t x, uint8_t nn);
             int opSetIndexRegister(uint16_t nnn);
-            int opDisplay(uint8_t x, uint8_t y, uint8_t n, std::shared_ptr<Display> display);
-            int opGetKey(uint8_t x, std::shared_ptr<Keyboard> keyboard);
+            template<SpriteEdge EDGE>
+            int opDisplay(uint8_t x, uint8_t y, uint8_t n, Display* display);
+            int opGetKey(uint8_t x, Keyboard* keyboard);
             int opFontCharacter(uint8_t x);
+            int opLargeFontCharacter(uint8_t x);
+            int opLoadLongIndex();
+            int opSelectPlanes(uint8_t x, Display* display);
+            template<bool INCREMENT_INDEX>
             int opStoreRegistersToMemory(uint8_t x);
+            template<bool INCREMENT_INDEX>
             int opLoadRegistersFromMemory(uint8_t x);
+            int opLoadAudioPattern();
+            int opSetPitch(uint8_t x);
             int opBinaryCodeDecimalConversion(uint8_t x);
             int opAddToIndex(uint8_t x);
             int opGetDelayTimer(uint8_t x);
             int opSetDelayTimer(uint8_t x);
             int opSetSoundTimer(uint8_t x);
+            void skipInstruction();
             int opSkipIfVxEqualsNn(uint8_t x, uint8_t nn);
             int opSkipIfVxNotEqualsNn(uint8_t x, uint8_t nn);
             int opSkipIfVxNotEqualsVy(uint8_t x, uint8_t y);
             int opSkipIfVxEqualsVy(uint8_t x, uint8_t y);
-            int opSkipIfKeyPressed(uint8_t x, std::shared_ptr<Keyboard> keyboard);
-            int opSkipIfNotKeyPressed(uint8_t x, std::shared_ptr<Keyboard> keyboard);
+            int opSkipIfKeyPressed(uint8_t x, Keyboard* keyboard);
+            int opSkipIfNotKeyPressed(uint8_t x, Keyboard* keyboard);
             int opRandom(uint8_t x, uint8_t nn);
-            int opJumpWithOffset(uint16_t nn);
+            template<bool USE_VX>
+            int opJumpWithOffset(uint8_t x, uint16_t nnn);
             int opSetVxToValueOfVy(uint8_t x, uint8_t y);
-            int opShiftRight(uint8_t x);
-            int opShiftLeft(uint8_t x);
+            template<bool USE_VY>
+            int opShiftRight(uint8_t x, uint8_t y);
+            template<bool USE_VY>
+            int opShiftLeft(uint8_t x, uint8_t y);
             int opSubtractVyFromVx(uint8_t x, uint8_t y);
             int opSubtractVxFromVy(uint8_t x, uint8_t y);
             int opAddWithCarry(uint8_t x, uint8_t y);
@@ -90,17 +207,23 @@ namespace Chip8 {
             int opBinaryAnd(uint8_t x, uint8_t y);
             int opJumpToSubroutine(uint16_t nnn);
 
-            uint16_t _pc;
-            uint16_t _index;
-            uint8_t _sp;
-            uint16_t _stack[16];
-            uint8_t _delayTimer;
-            uint8_t _soundTimer;
-            int _microSeconds;
+            CpuState _state;
+            uint64_t _instructionCount;
+            // budget left when FX18, F002 or FX3A last ran in the current
+            // frame
+            int32_t _soundWrittenAt;
+            bool _blockExecution;
+            bool _recompilation;
+            Quirks _quirks;
+            RunFunction _run;
+            ExecuteFunction _execute;
+            Timing _timing;
             std::shared_ptr<Memory> _memory;
             std::shared_ptr<Registers> _registers;
-
-            std::default_random_engine randGen;
-            std::uniform_int_distribution<uint8_t> randByte;
+            InstructionCache _instructionCache;
+            BlockCache _blockCache;
+#if defined(CHIP8_JIT_ENABLED)
+            Recompiler _recompiler;
+#endif
     };
 }
@@ -0,0 +1,103 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace Chip8 {
+
+    // Every operation the CPU knows, in the order used by the dispatch tables.
+    #define CHIP8_OPS(OP) \
+        OP(Invalid) \
+        OP(ClearScreen) \
+        OP(Return) \
+        OP(ReturnFromSubroutine) \
+        OP(Jump) \
+        OP(JumpToSubroutine) \
+        OP(SkipIfVxEqualsNn) \
+        OP(SkipIfVxNotEqualsNn) \
+        OP(SkipIfVxEqualsVy) \
+        OP(SetRegisterVxToNn) \
+        OP(AddNnToRegisterVx) \
+        OP(SetVxToValueOfVy) \
+        OP(BinaryOr) \
+        OP(BinaryAnd) \
+        OP(BinaryXor) \
+        OP(AddWithCarry) \
+        OP(SubtractVyFromVx) \
+        OP(ShiftRight) \
+        OP(SubtractVxFromVy) \
+        OP(ShiftLeft) \
+        OP(SkipIfVxNotEqualsVy) \
+        OP(SetIndexRegister) \
+        OP(JumpWithOffset) \
+        OP(Random) \
+        OP(Display) \
+        OP(SkipIfKeyPressed) \
+        OP(SkipIfNotKeyPressed) \
+        OP(GetDelayTimer) \
+        OP(GetKey) \
+        OP(SetDelayTimer) \
+        OP(SetSoundTimer) \
+        OP(AddToIndex) \
+        OP(FontCharacter) \
+        OP(BinaryCodeDecimalConversion) \
+        OP(StoreRegistersToMemory) \
+        OP(LoadRegistersFromMemory) \
+        OP(LoadAudioPattern) \
+        OP(SetPitch) \
+        OP(ScrollDown) \
+        OP(ScrollRight) \
+        OP(ScrollLeft) \
+        OP(LowResolution) \
+        OP(HighResolution) \
+        OP(LargeFontCharacter) \
+        OP(LoadLongIndex) \
+        OP(SelectPlanes)
+
+    enum class Op : uint8_t {
+        #define CHIP8_OP_ENUM(name) name,
+        CHIP8_OPS(CHIP8_OP_ENUM)
+        #undef CHIP8_OP_ENUM
+        Count
+    };
+
+    // An opcode split into its operation and operands.
+    struct Instruction {
+        uint16_t opcode;
+        uint16_t nnn;
+        Op op;
+        uint8_t x;
+        uint8_t y;
+        uint8_t n;
+        uint8_t nn;
+    };
+
+    class Decoder {
+        public:
+            // The operation of an opcode only depends on its top nibble and
+            // its low byte, so the table has 16x256 entries.
+            static Op decode(uint16_t opcode) {
+#if defined(CHIP8_DISPATCH_SWITCH)
+                return decodeSwitch(opcode);
+#else
+                return _table[((opcode & 0xF000) >> 4) | (opcode & 0x00FF)];
+#endif
+            }
+
+            static Op decodeSwitch(uint16_t opcode);
+
+            static Instruction decodeInstruction(uint16_t opcode) {
+                return Instruction {
+                    opcode,
+                    static_cast<uint16_t>(opcode & 0x0FFF),
+                    decode(opcode),
+                    static_cast<uint8_t>((opcode & 0x0F00) >> 8),
+                    static_cast<uint8_t>((opcode & 0x00F0) >> 4),
+                    static_cast<uint8_t>(opcode & 0x000F),
+                    static_cast<uint8_t>(opcode & 0x00FF)
+                };
+            }
+
+        private:
+            static const std::array<Op, 16 * 256> _table;
+    };
+}
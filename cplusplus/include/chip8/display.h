@@ -1,27 +1,86 @@
 #pragma once
 
-#include <SDL2/SDL.h>
+#include <cstdint>
+#include "chip8/memory.h"
 
 namespace Chip8 {
+    // What happens to the part of a sprite that crosses the edge of the
+    // screen. The start position always wraps around.
+    enum class SpriteEdge : uint8_t {
+        Clip,
+        Wrap
+    };
+
+    // The framebuffer, COLS x ROWS pixels or HIRES_COLS x HIRES_ROWS in
+    // the SUPER-CHIP high resolution mode. It is presented on screen by a
+    // Renderer.
+    //
+    // Rows are packed into words with column 0 in the most significant bit
+    // of the first word. A low resolution row is one word. A high
+    // resolution row is two, left half first, so that it is one aligned 128
+    // bit block: scrolling vertically moves whole rows and scrolling
+    // sideways shifts every row in a loop the compiler vectorizes.
+    //
+    // There are PLANES such framebuffers, the XO-CHIP bitplanes, one after
+    // the other. Drawing, scrolling and clearing only touch the planes
+    // selected with FN01, the first one unless a program selects others.
+    // Pixels take one of four colors, from the bit they have in each
+    // plane.
     class Display {
         public:
-            Display() = default;
-            ~Display() {
-                SDL_DestroyWindow( _window );
-            }
-            void init();
-            void flipPixel(int index);
             void setDrawFlag(bool value);
             bool getDrawFlag();
 
+            // XORs a sprite of up to 15 rows of 8 pixels onto the screen and
+            // returns true if any pixel was turned off. sprite holds height
+            // bytes for every selected plane, the first plane's first.
+            bool drawSprite(uint8_t x, uint8_t y, const uint8_t* sprite, uint8_t height, SpriteEdge edge);
+            // The same for a SUPER-CHIP sprite of 16 rows of 16 pixels, two
+            // bytes per row, so 32 bytes per selected plane.
+            bool drawLargeSprite(uint8_t x, uint8_t y, const uint8_t* sprite, SpriteEdge edge);
+
+            // Scrolls by a number of pixels of the current resolution.
+            // Pixels scrolled in are off.
+            void scrollDown(uint8_t pixels);
+            void scrollLeft(uint8_t pixels);
+            void scrollRight(uint8_t pixels);
+
+            // Switches resolution without clearing the screen.
+            void setHires(bool hires) { _hires = hires; }
+            bool isHires() const { return _hires; }
+            int getWidth() const { return _hires ? HIRES_COLS : COLS; }
+            int getHeight() const { return _hires ? HIRES_ROWS : ROWS; }
+            int getRowWords() const { return _hires ? 2 : 1; }
+
+            // Bit N selects plane N.
+            void selectPlanes(uint8_t planes) { _selectedPlanes = planes & ((1 << PLANES) - 1); }
+            uint8_t getSelectedPlanes() const { return _selectedPlanes; }
+            uint8_t getSelectedPlaneCount() const { return (_selectedPlanes & 1) + (_selectedPlanes >> 1); }
+
+            // getHeight() rows of getRowWords() words. The rest of the
+            // FRAME_WORDS words are 0.
+            const uint64_t* getPlane(int plane) const { return _planes[plane]; }
+            // the first plane, all that CHIP-8 and SUPER-CHIP programs draw to
+            const uint64_t* getRows() const { return _planes[0]; }
+            bool getPixel(int x, int y) const {
+                auto word = _planes[0][y * getRowWords() + x / 64];
+                return (word >> (63 - x % 64)) & 1;
+            }
+            // PLANES * FRAME_WORDS words, every plane in turn.
+            const uint64_t* getPlanes() const { return _planes[0]; }
+            void setPlanes(const uint64_t* planes);
+
+            // Clears the selected planes.
             void clear();
-            void draw();
+            void clearAll();
 
         private:
-            bool _drawFlag;
-            bool _frameBuffer[64*32];
-            SDL_Window* _window = nullptr;
-            SDL_Renderer* _renderer = nullptr;
+            bool draw(uint8_t x, uint8_t y, const uint64_t* lines, uint8_t height, uint8_t width, SpriteEdge edge);
+            bool drawPlane(uint64_t* plane, uint8_t x, uint8_t y, const uint64_t* lines, uint8_t height, uint8_t width, SpriteEdge edge);
 
+            bool _drawFlag = false;
+            bool _hires = false;
+            uint8_t _selectedPlanes = 1;
+            alignas(16) uint64_t _planes[PLANES][FRAME_WORDS] = {};
     };
 }
@@ -1,5 +1,12 @@
 #pragma once
+#include <atomic>
 #include <memory>
+#include <string>
+#include "chip8/frame_pacer.h"
+#include "chip8/renderer.h"
+#include "chip8/timing.h"
+#include "chip8/quirks.h"
+#include "chip8/triple_buffer.h"
 
 namespace Chip8 {
     class CPU;
@@ -7,17 +14,83 @@ namespace Chip8 {
     class Keyboard;
     class Audio;
     class Memory;
+    struct Snapshot;
+    class RewindBuffer;
+    class Movie;
 
+    // Runs the CPU on its own thread while the calling thread handles SDL
+    // events and presents frames, so that neither can stall the other.
+    // Frames reach the render thread through a triple buffer and the keypad
+    // state reaches the emulation thread as one atomic bitmask. The emulation
+    // thread runs one CPU tick per 60 Hz frame, paced by a FramePacer.
+    //
+    // F5 saves the machine to a snapshot slot in memory and F7 restores it.
+    // Both are carried out by the emulation thread between two frames.
+    // Every frame is recorded into a RewindBuffer, and holding Backspace
+    // steps back through it one frame per frame instead of running, with
+    // the beeper silent.
+    //
+    // When a movie is being recorded, the keypad state of every frame goes
+    // into it, and snapshots and rewinding are disabled since the movie
+    // could not replay them.
     class Emulator {
         public:
-            Emulator(std::shared_ptr<Memory>);
+            Emulator(std::shared_ptr<Memory>, int scale = SCALE, Palette palette = DEFAULT_PALETTE);
             ~Emulator();
             void run();
 
+            // Speed multiplier for the emulation thread, see
+            // FramePacer::setSpeed. Can be changed while running.
+            void setSpeed(double speed);
+
+            // How many instructions run per frame. Must be set before run().
+            void setTiming(const Timing& timing);
+            // Must be set before run().
+            void setQuirks(const Quirks& quirks);
+
+            // Seed of the random number generator, taken from the clock
+            // unless set.
+            void setSeed(uint32_t seed);
+
+            // Records the input from now on into a movie that is written to
+            // the file once run() returns. The movie keeps the seed, timing
+            // and quirks set so far, so set those first.
+            void recordMovie(char const* filename);
+
         private:
+            struct Frame {
+                uint64_t planes[PLANES * FRAME_WORDS];
+                bool hires;
+            };
+
+            // over half an hour at the 5-35 bytes per frame of the bundled ROMs
+            static constexpr size_t REWIND_BYTES = 4 * 1024 * 1024;
+
+            enum SnapshotRequest : uint8_t {
+                NONE,
+                SAVE,
+                RESTORE
+            };
+
+            void emulate();
+
             std::unique_ptr<CPU> _cpu;
             std::shared_ptr<Display> _display;
             std::shared_ptr<Keyboard> _keyboard;
             std::shared_ptr<Audio> _audio;
+            std::unique_ptr<Renderer> _renderer;
+            std::unique_ptr<Snapshot> _snapshot;
+            std::unique_ptr<RewindBuffer> _rewind;
+            std::unique_ptr<Movie> _movie;
+            std::string _movieFilename;
+            uint32_t _seed;
+
+            TripleBuffer<Frame> _frames;
+            std::atomic<uint16_t> _keys { 0 };
+            std::atomic<bool> _running { false };
+            std::atomic<uint8_t> _snapshotRequest { NONE };
+            std::atomic<bool> _rewinding { false };
+            std::atomic<double> _speed { 1.0 };
+            PacerStats _pacerStats = {};
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "chip8/rom.h"
+
+namespace Chip8 {
+    class CPU;
+    class Memory;
+    class Registers;
+    class Display;
+    class Keyboard;
+    class Audio;
+
+    // Owns many independent machines and steps them in batches on a pool of
+    // worker threads. Machines share no mutable state, so each batch is split
+    // between the workers, and a worker that runs out of machines steals
+    // half of what another worker has left.
+    //
+    // Machines must only be touched (input, framebuffer, state) between
+    // calls to runFrames.
+    class EmulatorPool {
+        public:
+            struct alignas(64) Machine {
+                std::shared_ptr<Memory> memory;
+                std::shared_ptr<Registers> registers;
+                std::shared_ptr<CPU> cpu;
+                std::shared_ptr<Display> display;
+                std::shared_ptr<Keyboard> keyboard;
+                std::shared_ptr<Audio> audio;
+            };
+
+            // threads == 0 uses one thread per hardware thread. The calling
+            // thread is one of them.
+            EmulatorPool(size_t machines, unsigned int threads = 0);
+            ~EmulatorPool();
+
+            EmulatorPool(const EmulatorPool&) = delete;
+            EmulatorPool& operator=(const EmulatorPool&) = delete;
+
+            // Load the program into every machine, or one of them. The file
+            // is read once and its image shared by all the machines it goes
+            // to. Set the quirks first, they decide how much memory there
+            // is. Loading into every machine stops at the first that fails
+            // and returns its error.
+            RomError loadROM(char const* filename);
+            RomError loadROM(const uint8_t* data, size_t length);
+            RomError loadROM(size_t machine, char const* filename);
+            RomError loadROM(size_t machine, const uint8_t* data, size_t length);
+
+            // Runs every machine for the given number of 60 Hz frames and
+            // returns once all of them are done.
+            void runFrames(uint64_t frames);
+
+            size_t getSize() const { return _machines.size(); }
+            unsigned int getThreadCount() const { return static_cast<unsigned int>(_workers.size()) + 1; }
+            Machine& getMachine(size_t machine) { return *_machines[machine]; }
+            uint64_t getInstructionCount() const;
+
+        private:
+            // Range of machine indices [begin, end) packed into one word so
+            // that the owner and thieves can claim work with a single CAS.
+            struct alignas(64) WorkRange {
+                std::atomic<uint64_t> range;
+            };
+
+            void workerLoop(unsigned int worker);
+            void runBatch(unsigned int worker);
+            bool popWork(unsigned int worker, size_t& machine);
+            bool stealWork(unsigned int worker);
+            void runMachine(Machine& machine);
+
+            std::vector<std::unique_ptr<Machine>> _machines;
+            std::vector<std::thread> _workers;
+            std::unique_ptr<WorkRange[]> _ranges;
+
+            std::mutex _mutex;
+            std::condition_variable _start;
+            std::condition_variable _done;
+            uint64_t _generation;
+            unsigned int _running;
+            bool _stop;
+            uint64_t _frames;
+    };
+}
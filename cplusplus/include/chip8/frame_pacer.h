@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+
+namespace Chip8 {
+    struct PacerStats {
+        uint64_t frames;
+        uint64_t dropped;
+        // how late the thread woke up after a deadline, in microseconds
+        double meanJitter;
+        double maxJitter;
+        // CPU time of the pacing thread divided by wall time
+        double cpuUsage;
+    };
+
+    // Paces a loop to a fixed frame rate by sleeping until absolute
+    // deadlines, so that time spent in the loop body does not add up to
+    // drift. Frame N is due at start + N / (rate * speed), computed exactly
+    // at normal speed.
+    class FramePacer {
+        public:
+            // At most this many frames are run back to back to catch up
+            // after a stall. Frames beyond that are dropped and the schedule
+            // moves forward.
+            static const uint32_t MAX_CATCH_UP = 4;
+
+            // Speed at which wait() never sleeps.
+            static constexpr double UNLIMITED = 0.0;
+
+            explicit FramePacer(uint32_t rate = 60);
+
+            // Sleeps until the next frame is due and returns how many frames
+            // should be run now (1 unless the caller fell behind).
+            uint32_t wait();
+
+            // Scales the frame rate, so 0.25 runs frames at a quarter of the
+            // rate and 2 at twice the rate. Anything not above 0 is UNLIMITED.
+            // Each frame is still one frame of guest time, so the guest's
+            // timers keep ticking once per frame.
+            void setSpeed(double speed);
+            double getSpeed() const { return _speed; }
+
+            PacerStats getStats() const;
+
+        private:
+            int64_t deadline(uint64_t frame) const;
+
+            uint32_t _rate;
+            double _speed;
+            bool _started;
+            int64_t _start;
+            // the schedule restarts here when the speed changes
+            int64_t _epoch;
+            uint64_t _epochFrame;
+            int64_t _startCpu;
+            uint64_t _next;
+            uint64_t _frames;
+            uint64_t _dropped;
+            uint64_t _sleeps;
+            int64_t _totalJitter;
+            int64_t _maxJitter;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include "chip8/decoder.h"
+#include "chip8/memory.h"
+
+namespace Chip8 {
+
+    // Decoded instructions indexed by program address. Instructions are
+    // always fetched from even addresses in practice, so there is one slot
+    // per 16 bit word of memory. Writes to memory drop the slot covering
+    // every written byte, which keeps self-modifying programs correct.
+    class InstructionCache : public MemoryObserver {
+        public:
+            static const uint16_t SLOTS = RAM_SIZE / 2;
+
+            InstructionCache();
+
+            // Instructions at odd addresses are decoded on every fetch.
+            const Instruction& fetch(uint16_t pc, Memory& memory) {
+                if((pc & 1) != 0 || pc >= RAM_SIZE) {
+                    _uncached = Decoder::decodeInstruction(memory.get(pc) << 8 | memory.get(pc + 1));
+                    return _uncached;
+                }
+                auto& slot = _slots[pc >> 1];
+                if(!slot.valid) {
+                    slot.instruction = Decoder::decodeInstruction(memory.get(pc) << 8 | memory.get(pc + 1));
+                    slot.valid = true;
+                }
+                return slot.instruction;
+            }
+
+            void invalidate();
+            void onMemoryWritten(uint16_t addr, uint16_t length) override;
+
+        private:
+            struct Slot {
+                Instruction instruction;
+                bool valid;
+            };
+
+            Slot _slots[SLOTS];
+            Instruction _uncached;
+    };
+}
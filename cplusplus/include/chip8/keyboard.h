@@ -16,8 +16,29 @@ namespace Chip8
 
         void handleKeyDown(SDL_Keycode key);
         void handleKeyUp(SDL_Keycode key);
+
+        // Keypad key (0-F) for a key on the host keyboard, or -1 if it is
+        // not mapped.
+        static int mapKey(SDL_Keycode key);
+
+        // Pressed keys as a bitmask, with key N in bit N.
+        uint16_t getState() const;
+        void setState(uint16_t keys);
+
+        // Sets a key of the 16-key keypad directly, for input that does not
+        // come from SDL.
+        void setKey(uint8_t key, bool pressed) {
+            auto bit = static_cast<uint16_t>(1 << (key & 0xF));
+            _keypad = pressed ? _keypad | bit : _keypad & ~bit;
+        }
+
+        // Keys as they were at the last update, which FX0A compares against
+        // to see a key being released.
+        uint16_t getLastState() const { return _lastState; }
+        void setLastState(uint16_t keys) { _lastState = keys; }
     private:
-        bool _keypad[16];
-        bool _lastState[16];
+        // key N in bit N
+        uint16_t _keypad;
+        uint16_t _lastState;
     };   
 }
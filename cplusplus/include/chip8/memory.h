@@ -1,27 +1,79 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <vector>
+#include "chip8/rom.h"
 
 namespace Chip8 {
 
     const uint16_t SPRITE_CHARS_ADDR = 0x0000;
+    // SUPER-CHIP's 8x10 digits, right after the 4x5 ones
+    const uint16_t LARGE_SPRITE_CHARS_ADDR = 0x0050;
     const uint32_t FRAME_TICKS = 16666;
     const uint16_t RAM_SIZE= 4096;
+    // XO-CHIP's whole 16 bit address space
+    const uint32_t XO_RAM_SIZE = 65536;
     const uint16_t PROGRAM_START_ADDRESS = 0x0200;
     const uint16_t REGISTER_COUNT = 16;
     const uint8_t STACK_DEPTH = 16;
     const uint8_t SCALE = 10;
     const uint8_t COLS = 64;
     const uint8_t ROWS = 32;
+    const uint8_t HIRES_COLS = 128;
+    const uint8_t HIRES_ROWS = 64;
+    // the framebuffer at either resolution, in 64-bit words
+    const uint16_t FRAME_WORDS = HIRES_COLS / 64 * HIRES_ROWS;
+    // XO-CHIP bitplanes, FRAME_WORDS words each
+    const uint8_t PLANES = 2;
+    // XO-CHIP audio: bytes in the 1-bit pattern F002 loads, and the pitch
+    // FX3A sets that plays it at 4000 bits per second
+    const uint8_t PATTERN_SIZE = 16;
+    const uint8_t DEFAULT_PITCH = 64;
 
+    // Notified whenever a range of memory has been written, so that anything
+    // derived from the program (like decoded instructions) can be dropped.
+    class MemoryObserver {
+        public:
+            virtual ~MemoryObserver() = default;
+            virtual void onMemoryWritten(uint16_t addr, uint16_t length) = 0;
+    };
+
+    // RAM_SIZE bytes like the COSMAC VIP, or XO_RAM_SIZE for XO-CHIP. Only
+    // getSize() bytes are allocated, so machines that run CHIP-8 programs
+    // stay small however many of them there are.
     class Memory {
         public:
             Memory();
+            void addObserver(MemoryObserver* observer);
+            void removeObserver(MemoryObserver* observer);
             void set(uint16_t addr, uint8_t value);
-            uint8_t get(uint16_t addr);
+            // Addresses wrap around at the end of memory, as on the COSMAC VIP.
+            uint8_t get(uint16_t addr) { return _ram[addr & _mask]; }
             void load(int addr, uint8_t* data, int length);
-            void loadROM(char const* filename);
+            // Copy a program to PROGRAM_START_ADDRESS. Memory is left as
+            // it was if the file can not be read or the program does not
+            // fit in getSize() bytes.
+            RomError loadROM(char const* filename);
+            RomError loadROM(const uint8_t* data, size_t length);
+
+            // RAM_SIZE or XO_RAM_SIZE. Set before loading the program.
+            // Growing adds zeroed memory, shrinking drops the bytes above
+            // the new size.
+            void setSize(uint32_t size);
+            uint32_t getSize() const { return _mask + 1u; }
+
+            // getSize() bytes
+            const uint8_t* data() const { return _ram.data(); }
+            // Overwrites memory like load, but observers only hear about the
+            // parts that actually changed. Writes nothing and returns false
+            // if the range does not fit in getSize() bytes.
+            bool restore(uint16_t addr, const uint8_t* data, uint32_t length);
 
         private:
-            uint8_t _ram[4096]; 
+            void notifyWritten(uint16_t addr, uint16_t length);
+
+            uint16_t _mask = RAM_SIZE - 1;
+            std::vector<uint8_t> _ram;
+            std::vector<MemoryObserver*> _observers;
     };
 }
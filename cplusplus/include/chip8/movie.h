@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "chip8/quirks.h"
+#include "chip8/timing.h"
+
+namespace Chip8 {
+    // Keypad input of a run, frame by frame, together with the seed of the
+    // random number generator and the timing and quirks the run used. A
+    // machine set up with those that sees getKeys(frame) before every tick
+    // replays the run exactly.
+    //
+    // Only changes are stored. Files are little-endian: "C8MV", version,
+    // seed, frame budget, instruction cost, quirk mask, memory size, number
+    // of frames and number of changes as 32-bit words, then every change as
+    // a 32-bit frame and a 16-bit keypad bitmask.
+    class Movie {
+        public:
+            static const uint32_t VERSION = 2;
+
+            explicit Movie(uint32_t seed = 0, const Timing& timing = Timing::vip(), const Quirks& quirks = Quirks());
+
+            uint32_t getSeed() const { return _seed; }
+            const Timing& getTiming() const { return _timing; }
+            const Quirks& getQuirks() const { return _quirks; }
+            // frames recorded, or to be replayed
+            uint32_t getFrames() const { return _frames; }
+
+            // Keys held during the given frame. Frames must be recorded in
+            // order.
+            void record(uint32_t frame, uint16_t keys);
+            uint16_t getKeys(uint32_t frame) const;
+
+            bool write(char const* filename) const;
+            bool read(char const* filename);
+
+        private:
+            struct Input {
+                uint32_t frame;
+                uint16_t keys;
+            };
+
+            uint32_t _seed;
+            Timing _timing;
+            Quirks _quirks;
+            uint32_t _frames;
+            std::vector<Input> _inputs;
+    };
+}
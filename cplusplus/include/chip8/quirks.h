@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include "chip8/display.h"
+
+namespace Chip8 {
+    // Instructions whose behaviour differs between the original CHIP-8
+    // interpreter and its successors. A default constructed Quirks is how
+    // this emulator has always behaved, which matches no single platform.
+    //
+    // The CPU is specialized at compile time for every combination, see
+    // getMask(), so checking a quirk costs nothing per instruction.
+    struct Quirks {
+        static const uint8_t SHIFT_USES_VY = 1 << 0;
+        static const uint8_t LOAD_STORE_INCREMENTS_INDEX = 1 << 1;
+        static const uint8_t JUMP_USES_VX = 1 << 2;
+        static const uint8_t SPRITES_WRAP = 1 << 3;
+        static const uint8_t COMBINATIONS = 1 << 4;
+
+        // 8XY6 and 8XYE shift VY into VX instead of shifting VX in place.
+        bool shiftUsesVy = false;
+        // FX55 and FX65 leave I pointing after the last register.
+        bool loadStoreIncrementsIndex = false;
+        // BXNN jumps to XNN + VX instead of NNN + V0.
+        bool jumpUsesVx = false;
+        // Whether DXYN clips sprites at the edge of the screen or wraps
+        // them around.
+        SpriteEdge spriteEdge = SpriteEdge::Clip;
+        // Bytes of RAM, RAM_SIZE or XO_RAM_SIZE. Memory masks the addresses
+        // itself, so this is not part of the mask.
+        uint32_t memorySize = RAM_SIZE;
+
+        uint8_t getMask() const;
+        static Quirks fromMask(uint8_t mask);
+
+        bool operator==(const Quirks& other) const {
+            return getMask() == other.getMask() && memorySize == other.memorySize;
+        }
+        bool operator!=(const Quirks& other) const { return !(*this == other); }
+
+        // the original interpreter on the COSMAC VIP
+        static Quirks chip8();
+        // SUPER-CHIP 1.1 on the HP 48
+        static Quirks superChip();
+        // XO-CHIP as implemented by Octo
+        static Quirks xoChip();
+
+        // Reads "default", "chip8", "schip" or "xochip".
+        static bool parse(char const* name, Quirks& quirks);
+    };
+}
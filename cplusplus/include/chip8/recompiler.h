@@ -0,0 +1,81 @@
+#pragma once
+#if defined(CHIP8_JIT_ENABLED)
+#include <cstddef>
+#include <cstdint>
+#include "chip8/memory.h"
+
+namespace Chip8 {
+
+    // The machine state recompiled code works on. Generated code addresses
+    // every field relative to the pointer it is called with.
+    struct JitState {
+        uint8_t* v;
+        uint16_t index;
+        uint16_t pc;
+        int32_t microSeconds;
+        uint64_t instructionCount;
+        uint8_t delayTimer;
+        uint8_t soundTimer;
+    };
+
+    // Translates hot regions of CHIP-8 code to x86-64. A region starts at an
+    // even address and runs until the first instruction that is not
+    // register arithmetic, ANNN, FX1E, FX07, FX15, a register skip or 1NNN.
+    // The other instructions, including DXYN, FX0A, EX9E and FX18, which
+    // switches the beeper, are left to the interpreter, and so are skips
+    // over XO-CHIP's four byte F000 NNNN. Generated code charges the cycle
+    // budget after every instruction and leaves as soon as it is spent,
+    // exactly like the interpreter does, and loops natively when the region
+    // jumps back to its own start.
+    //
+    // Code lives in an arena whose pages are either writable or executable,
+    // never both, so that hardened kernels that refuse such mappings still
+    // run it.
+    class Recompiler : public MemoryObserver {
+        public:
+            typedef void (*Code)(JitState* state);
+
+            static const uint8_t MAX_LENGTH = 32;
+            static const uint8_t HOT_THRESHOLD = 16;
+            static const size_t ARENA_SIZE = 1 << 20;
+
+            Recompiler();
+            ~Recompiler();
+
+            Recompiler(const Recompiler&) = delete;
+            Recompiler& operator=(const Recompiler&) = delete;
+
+            // Returns native code for the region at pc once it has been
+            // looked up HOT_THRESHOLD times, nullptr until then or if the
+            // region can not be compiled.
+            Code lookup(uint16_t pc, Memory& memory);
+
+            // Charges every instruction the same cost instead of its cycles
+            // on the VIP, unless 0. Code compiled before is thrown away.
+            void setInstructionCost(int32_t cost);
+
+            // The only quirk that matters to compiled code, see
+            // Quirks::shiftUsesVy. Code compiled before is thrown away.
+            void setShiftUsesVy(bool shiftUsesVy);
+
+            void invalidate();
+            void onMemoryWritten(uint16_t addr, uint16_t length) override;
+
+        private:
+            struct Region {
+                Code code;
+                uint16_t end;
+                uint8_t hits;
+                bool compiled;
+            };
+
+            void compile(uint16_t pc, Memory& memory, Region& region);
+
+            uint8_t* _arena;
+            size_t _used;
+            int32_t _instructionCost;
+            bool _shiftUsesVy;
+            Region _regions[RAM_SIZE / 2];
+    };
+}
+#endif
@@ -6,13 +6,14 @@ namespace Chip8
     class Registers
     {
     private:
-        char _registers[16];
+        alignas(16) uint8_t _registers[16];
 
     public:    
         Registers();
         ~Registers();
-        void set(uint8_t index, uint8_t value);
-        uint8_t get(uint8_t index);
+        void set(uint8_t index, uint8_t value) { _registers[index] = value; }
+        uint8_t get(uint8_t index) { return _registers[index]; }
+        uint8_t* data() { return _registers; }
     };
     
 } // namespace Chip8
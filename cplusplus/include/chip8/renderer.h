@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <SDL2/SDL.h>
+#include "chip8/memory.h"
+
+namespace Chip8 {
+    // Colors as 0xAARRGGBB. XO-CHIP pixels can also be set in the second
+    // bitplane only, or in both.
+    struct Palette {
+        uint32_t background;
+        uint32_t foreground;
+        uint32_t secondPlane = 0xFFAAAAAA;
+        uint32_t bothPlanes = 0xFF555555;
+    };
+
+    const Palette DEFAULT_PALETTE = { 0xFF000000, 0xFFFFFFFF };
+
+    // Presents the framebuffer through one streaming texture that SDL scales
+    // to the window. The texture is only uploaded when the frame differs
+    // from the last one uploaded.
+    //
+    // The texture has room for the high resolution picture. A low
+    // resolution frame fills its top left quarter, which is what is scaled
+    // to the window then. Each pixel takes the palette color for its bits
+    // in the bitplanes, which are composed in a single pass.
+    class Renderer {
+        public:
+            Renderer(int scale = SCALE, Palette palette = DEFAULT_PALETTE);
+            ~Renderer();
+
+            Renderer(const Renderer&) = delete;
+            Renderer& operator=(const Renderer&) = delete;
+
+            // Creates the window, renderer and texture. Returns false if SDL
+            // could not create them.
+            bool init();
+
+            void setPalette(Palette palette);
+            // planes are laid out as Display::getPlanes() returns them.
+            void present(const uint64_t* planes, bool hires = false);
+
+            uint64_t getUploadCount() const { return _uploads; }
+            // getWidth() pixels per row.
+            const uint32_t* getPixels() const { return _pixels; }
+            int getWidth() const { return _hires ? HIRES_COLS : COLS; }
+            int getHeight() const { return _hires ? HIRES_ROWS : ROWS; }
+
+        private:
+            int _scale;
+            Palette _palette;
+            bool _dirty = true;
+            uint64_t _uploads = 0;
+            bool _hires = false;
+            uint64_t _planes[PLANES * FRAME_WORDS] = {};
+            uint32_t _pixels[HIRES_COLS * HIRES_ROWS] = {};
+            SDL_Window* _window = nullptr;
+            SDL_Renderer* _renderer = nullptr;
+            SDL_Texture* _texture = nullptr;
+    };
+}
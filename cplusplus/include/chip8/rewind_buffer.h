@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Chip8 {
+    class CPU;
+    class Display;
+    class Keyboard;
+    struct Snapshot;
+
+    // History of machine states for rewinding, recorded once per frame into
+    // a ring of a fixed number of bytes. Only the newest state is kept whole.
+    // Every older state is kept as the XOR of it and the state after it,
+    // run-length encoded, which leaves a few dozen bytes for a typical frame.
+    // Once the ring is full the oldest states are dropped.
+    class RewindBuffer {
+        public:
+            explicit RewindBuffer(size_t capacity);
+            ~RewindBuffer();
+
+            RewindBuffer(const RewindBuffer&) = delete;
+            RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+            void record(const CPU& cpu, const Display& display, const Keyboard& keyboard);
+
+            // Puts the machine back into the state recorded before the newest
+            // one, which then becomes the newest, so each call steps back one
+            // more frame. Fails once there is nothing older left.
+            bool rewind(CPU& cpu, Display& display, Keyboard& keyboard);
+
+            // states older than the newest that can still be rewound to
+            size_t getFrames() const { return _deltas.size(); }
+            // bytes of the ring holding deltas
+            size_t getUsedBytes() const;
+            size_t getCapacity() const { return _ring.size(); }
+
+        private:
+            struct Delta {
+                size_t offset;
+                size_t size;
+            };
+
+            size_t encode(const uint8_t* newer, const uint8_t* older, size_t length);
+            void decode(const Delta& delta, uint8_t* state) const;
+            void push(size_t size);
+
+            std::unique_ptr<Snapshot> _newest;
+            std::unique_ptr<Snapshot> _next;
+            bool _hasState;
+            std::vector<uint8_t> _scratch;
+
+            std::vector<uint8_t> _ring;
+            // oldest first, laid out in the ring in the same order
+            std::deque<Delta> _deltas;
+            size_t _head;
+    };
+}
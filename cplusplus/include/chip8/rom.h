@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Chip8 {
+    // Why a ROM could not be loaded.
+    enum class RomError : uint8_t {
+        None,
+        CanNotOpen,
+        NotAFile,
+        Empty,
+        CanNotMap,
+        // larger than the memory above PROGRAM_START_ADDRESS
+        TooLarge
+    };
+
+    // A short description of the error, for messages.
+    char const* describe(RomError error);
+
+    // A ROM file mapped read-only into memory. The pages are shared with
+    // the page cache and with every other mapping of the same file, so one
+    // Rom can be loaded into any number of machines without reading the
+    // file again.
+    //
+    // Where mmap is not available the file is read into a buffer instead.
+    class Rom {
+        public:
+            Rom() = default;
+            ~Rom();
+
+            Rom(const Rom&) = delete;
+            Rom& operator=(const Rom&) = delete;
+
+            // Maps the file, replacing whatever was open. Nothing is open
+            // after an error.
+            RomError open(char const* filename);
+            void close();
+
+            const uint8_t* data() const { return _data; }
+            size_t size() const { return _size; }
+
+        private:
+            const uint8_t* _data = nullptr;
+            size_t _size = 0;
+            // holds the file where it is read rather than mapped
+            std::vector<uint8_t> _buffer;
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "chip8/cpu.h"
+#include "chip8/memory.h"
+
+namespace Chip8 {
+    class Display;
+    class Keyboard;
+
+    // Complete state of one machine in a single flat block, so that saving
+    // and restoring are a handful of copies. Holds everything that decides
+    // what the machine does next: RAM, V0-VF, the CPU state (including the
+    // random number generator), the framebuffer and the keypad.
+    //
+    // RAM comes last and only its first ramSize bytes are used, so a
+    // CHIP-8 machine does not pay for XO-CHIP's 64 KB. getLength() is what
+    // is copied, compared and written.
+    //
+    // Files are the struct as it is in memory, so they are only meant to be
+    // read back by the same build on the same kind of host. A version or
+    // layout mismatch is caught by the header and rejected.
+    struct Snapshot {
+        static const uint32_t MAGIC = 0x38504843; // "CHP8"
+        static const uint32_t VERSION = 4;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t size;
+        uint32_t ramSize;
+        uint16_t keys;
+        uint16_t lastKeys;
+        bool hires;
+        uint8_t selectedPlanes;
+        uint64_t instructionCount;
+        CpuState cpu;
+        uint8_t registers[REGISTER_COUNT];
+        uint64_t planes[PLANES][FRAME_WORDS];
+        uint8_t ram[XO_RAM_SIZE];
+
+        size_t getLength() const { return offsetof(Snapshot, ram) + ramSize; }
+
+        void save(const CPU& cpu, const Display& display, const Keyboard& keyboard);
+
+        // Fails, leaving the machine alone, if the snapshot was not saved by
+        // this version or for another size of memory.
+        bool restore(CPU& cpu, Display& display, Keyboard& keyboard) const;
+
+        bool write(char const* filename) const;
+        bool read(char const* filename);
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "chip8/cpu.h"
+#include "chip8/memory.h"
+
+namespace Chip8 {
+    class Display;
+    class Keyboard;
+
+    struct StoreUsage {
+        uint32_t states;
+        uint32_t pages;
+        // bytes held by states and pages, including free slots kept for reuse
+        uint64_t bytes;
+        // what the live states would take as flat Snapshots
+        uint64_t flatBytes;
+    };
+
+    // Keeps many machine states for branching searches, where thousands of
+    // states fork from a few checkpoints and differ in a handful of bytes.
+    //
+    // RAM is split into pages of PAGE_SIZE bytes and the framebuffer into
+    // FRAME_PAGES more. A low resolution picture only fills the first page
+    // of each plane, so the others stay shared. Pages are immutable and
+    // reference counted, so forking a state only copies its page table, and
+    // saving a state against a parent only allocates the pages that differ
+    // from the parent's.
+    //
+    // Not thread safe. States are referred to by ids, which are reused once
+    // a state is released. All states of a store come from machines with
+    // the same size of memory, which sets the length of their page tables.
+    class SnapshotStore {
+        public:
+            typedef uint32_t Id;
+            static const Id NONE = UINT32_MAX;
+
+            static const uint16_t PAGE_SIZE = 256;
+            static const uint16_t RAM_PAGES = RAM_SIZE / PAGE_SIZE;
+            static const uint16_t FRAME_PAGES = PLANES * FRAME_WORDS * sizeof(uint64_t) / PAGE_SIZE;
+            // pages of a machine with RAM_SIZE bytes of RAM, the framebuffer
+            // followed by RAM
+            static const uint16_t PAGES = FRAME_PAGES + RAM_PAGES;
+
+            // Captures a machine. Pages equal to the parent's are shared
+            // with it instead of being copied. Returns NONE if its memory
+            // is not the size of the other states', or the parent is not
+            // live.
+            Id save(const CPU& cpu, const Display& display, const Keyboard& keyboard, Id parent = NONE);
+
+            // New state identical to the given one, sharing all its pages,
+            // or NONE if that state is not live.
+            Id fork(Id state);
+
+            // Puts the machine back into a saved state. Only RAM that differs
+            // is written, so caches of the CPU stay valid elsewhere. Fails,
+            // leaving the machine alone, if its memory is not the size of
+            // the states' or the state is not live.
+            bool restore(Id state, CPU& cpu, Display& display, Keyboard& keyboard) const;
+
+            // Returns false, changing nothing, if the state is not live,
+            // for instance because it was released already.
+            bool release(Id state);
+
+            bool isLive(Id state) const { return state < _states.size() && _states[state].live; }
+            StoreUsage getUsage() const;
+
+        private:
+            struct State {
+                CpuState cpu;
+                uint64_t instructionCount;
+                uint8_t registers[REGISTER_COUNT];
+                uint16_t keys;
+                uint16_t lastKeys;
+                bool hires;
+                uint8_t selectedPlanes;
+                bool live;
+            };
+
+            Id allocateState();
+            uint32_t allocatePage(const uint8_t* data);
+            const uint8_t* page(uint32_t page) const { return &_pageData[page * PAGE_SIZE]; }
+            uint32_t* pages(Id state) { return &_pageTables[state * _pageCount]; }
+            const uint32_t* pages(Id state) const { return &_pageTables[state * _pageCount]; }
+
+            std::vector<State> _states;
+            std::vector<Id> _freeStates;
+            // _pageCount pages per state, set by a save into an empty store
+            uint32_t _pageCount = 0;
+            std::vector<uint32_t> _pageTables;
+
+            // one PAGE_SIZE block and one reference count per page
+            std::vector<uint8_t> _pageData;
+            std::vector<uint32_t> _pageRefs;
+            std::vector<uint32_t> _freePages;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include "chip8/memory.h"
+
+namespace Chip8 {
+    // How many instructions run per 60 Hz frame. Every frame adds
+    // frameBudget to the CPU's budget and every instruction takes its cost
+    // off, until the budget is spent. What is left over, or overdrawn,
+    // carries into the next frame.
+    struct Timing {
+        // Instructions per frame when running as fast as possible.
+        static const int32_t UNLIMITED_SLICE = 1 << 16;
+
+        int32_t frameBudget;
+        // What every instruction costs, or 0 for the time it took on the
+        // COSMAC VIP, in microseconds.
+        int32_t instructionCost;
+
+        int32_t cost(int32_t vipCost) const { return instructionCost != 0 ? instructionCost : vipCost; }
+
+        bool operator==(const Timing& other) const {
+            return frameBudget == other.frameBudget && instructionCost == other.instructionCost;
+        }
+        bool operator!=(const Timing& other) const { return !(*this == other); }
+
+        // Instructions take as long as they did in the original interpreter
+        // on the COSMAC VIP.
+        static Timing vip() { return { static_cast<int32_t>(FRAME_TICKS), 0 }; }
+
+        // Every instruction takes the same time, so that the given number of
+        // them run per second. The budget is counted in 1 / (60 * rate)
+        // seconds, so rates that are not a multiple of 60 come out exact
+        // over a second.
+        static Timing fixed(uint32_t instructionsPerSecond) { return { static_cast<int32_t>(instructionsPerSecond), 60 }; }
+
+        // Runs UNLIMITED_SLICE instructions per frame, far more than any
+        // game expects, for benchmarks and fast forwarding. Timers still
+        // count down once per frame.
+        static Timing unlimited() { return { UNLIMITED_SLICE, 1 }; }
+
+        // Reads "vip", "fast" or an instruction rate such as "700".
+        static bool parse(char const* text, Timing& timing);
+    };
+}
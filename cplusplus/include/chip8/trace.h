@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+namespace Chip8 {
+
+    enum class TraceLevel : uint8_t {
+        Error = 0,
+        Info = 1,
+        Debug = 2
+    };
+
+    enum class TraceCategory : uint8_t {
+        Fetch = 0,
+        Decode = 1,
+        Memory = 2,
+        Display = 3,
+        Input = 4
+    };
+
+    // A trace record keeps the format string and its integer arguments, the
+    // text is only produced when the ring buffer is drained. Format strings
+    // must therefore be string literals.
+    struct TraceRecord {
+        TraceLevel level;
+        TraceCategory category;
+        char const* format;
+        int args[4];
+    };
+
+    // Single producer, single consumer ring buffer of trace records. The
+    // emulation thread writes records, whoever owns the output drains them.
+    // When the ring is full new records are dropped and counted.
+    class Trace {
+        public:
+            static const uint32_t CAPACITY = 4096;
+
+            static void setLevel(TraceLevel level) { _level.store(level, std::memory_order_relaxed); }
+            static void enableCategory(TraceCategory category, bool enabled);
+            static bool isEnabled(TraceLevel level, TraceCategory category) {
+                return level <= _level.load(std::memory_order_relaxed)
+                    && (_categories.load(std::memory_order_relaxed) & (1u << static_cast<uint8_t>(category))) != 0;
+            }
+
+            static void write(
+                TraceLevel level,
+                TraceCategory category,
+                char const* format,
+                int arg0 = 0, int arg1 = 0, int arg2 = 0, int arg3 = 0);
+            static uint32_t drain(FILE* file);
+            static uint64_t getDropped() { return _dropped.load(std::memory_order_relaxed); }
+
+        private:
+            static TraceRecord _records[CAPACITY];
+            static std::atomic<uint32_t> _head;
+            static std::atomic<uint32_t> _tail;
+            static std::atomic<uint64_t> _dropped;
+            static std::atomic<TraceLevel> _level;
+            static std::atomic<uint32_t> _categories;
+    };
+}
+
+#ifdef CHIP8_TRACE_ENABLED
+#define CHIP8_TRACE(level, category, ...) \
+    do { \
+        if(Chip8::Trace::isEnabled(Chip8::TraceLevel::level, Chip8::TraceCategory::category)) { \
+            Chip8::Trace::write(Chip8::TraceLevel::level, Chip8::TraceCategory::category, __VA_ARGS__); \
+        } \
+    } while(0)
+#define CHIP8_TRACE_DRAIN(file) Chip8::Trace::drain(file)
+#else
+#define CHIP8_TRACE(level, category, ...) do { } while(0)
+#define CHIP8_TRACE_DRAIN(file) do { } while(0)
+#endif
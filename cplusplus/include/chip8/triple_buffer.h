@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace Chip8 {
+    // Hands the latest value from one producer thread to one consumer
+    // thread without locks. The producer fills the back buffer and
+    // publishes it, which swaps it with the middle buffer. The consumer
+    // swaps the middle buffer with its front buffer whenever a new value
+    // has been published. Neither side ever waits for the other, and the
+    // consumer skips values it was too slow to see.
+    template<typename T>
+    class TripleBuffer {
+        public:
+            // Buffer that the producer writes to.
+            T& back() { return _buffers[_back]; }
+
+            void publish() {
+                _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX;
+            }
+
+            // Makes the latest published value the front buffer. Returns false
+            // if nothing has been published since the last call.
+            bool update() {
+                if((_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+                    return false;
+                }
+                _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+                return true;
+            }
+
+            // Buffer that the consumer reads from.
+            const T& front() const { return _buffers[_front]; }
+
+        private:
+            static const uint8_t INDEX = 0x3;
+            static const uint8_t FRESH = 0x4;
+
+            T _buffers[3] = {};
+            uint8_t _back = 0;
+            std::atomic<uint8_t> _middle { 1 };
+            uint8_t _front = 2;
+    };
+}
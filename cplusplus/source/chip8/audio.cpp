@@ -1,26 +1,234 @@
 #include "chip8/audio.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 
 using namespace Chip8;
-    
+
+// Phase increment per sample when the levels repeat at the given rate.
+static uint32_t phaseStep(double periodsPerSecond, int sampleRate)
+{
+    return static_cast<uint32_t>(std::ldexp(periodsPerSecond, 32) / sampleRate);
+}
+
+static uint32_t patternStep(uint8_t pitch, int sampleRate)
+{
+    auto bitsPerSecond = 4000.0 * std::pow(2.0, (pitch - 64) / 48.0);
+    return phaseStep(bitsPerSecond / Audio::LEVELS, sampleRate);
+}
+
+// Turns one period of levels into samples, with the phase advancing by
+// step per sample. Branch-free, so that it runs in batches.
+static uint32_t resample(const int16_t* levels, uint32_t phase, uint32_t step, int16_t* samples, int count)
+{
+    for(int i = 0; i < count; i++) {
+        samples[i] = levels[(phase + static_cast<uint32_t>(i) * step) >> 25];
+    }
+    return phase + static_cast<uint32_t>(count) * step;
+}
+
 Audio::Audio()
+    : _device(0)
+    , _sampleRate(SAMPLE_RATE)
+    , _frame(0)
+    , _playing(false)
+    , _pending(false)
+    , _hasPattern(false)
+    , _pitch(DEFAULT_PITCH)
+    , _pattern()
+    , _events()
+    , _clock(0)
+    , _offset(0)
+    , _on(false)
+    , _phase(0)
+    , _step(0)
+    , _levels()
 {
+    apply({ 0, phaseStep(FREQUENCY, SAMPLE_RATE), false, false, {} });
 }
 
 Audio::~Audio()
 {
+    close();
 }
 
-void Audio::play()
+bool Audio::open(char const* device)
 {
+    close();
+    SDL_AudioSpec wanted = {};
+    wanted.freq = SAMPLE_RATE;
+    wanted.format = AUDIO_S16SYS;
+    wanted.channels = 1;
+    wanted.samples = BUFFER_SAMPLES;
+    wanted.callback = &Audio::callback;
+    wanted.userdata = this;
+    SDL_AudioSpec obtained = {};
+    _device = SDL_OpenAudioDevice(device, 0, &wanted, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if(_device == 0) {
+        printf("Could not open audio device! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    _sampleRate = obtained.freq;
+    _step = phaseStep(FREQUENCY, _sampleRate);
+    SDL_PauseAudioDevice(_device, 0);
+    return true;
+}
+
+void Audio::close()
+{
+    if(_device != 0) {
+        SDL_CloseAudioDevice(_device);
+        _device = 0;
+    }
+}
+
+void Audio::callback(void* userdata, Uint8* stream, int length)
+{
+    auto audio = static_cast<Audio*>(userdata);
+    audio->mix(reinterpret_cast<int16_t*>(stream), length / static_cast<int>(sizeof(int16_t)));
+}
 
+void Audio::beginFrame()
+{
+    _frame++;
+    if(_pending) {
+        push(0.0f);
+    }
 }
 
-void Audio::pause()
+void Audio::play(float offset)
 {
+    _playing = true;
+    push(offset);
+}
 
+void Audio::pause(float offset)
+{
+    _playing = false;
+    push(offset);
 }
 
-bool Audio::isPlaying()
+void Audio::setPattern(const uint8_t* pattern, uint8_t pitch, float offset)
 {
-    return false;
-}
\ No newline at end of file
+    _hasPattern = pattern != nullptr;
+    _pitch = pitch;
+    if(pattern != nullptr) {
+        memcpy(_pattern, pattern, PATTERN_SIZE);
+    }
+    push(offset);
+}
+
+bool Audio::playsPattern(const uint8_t* pattern, uint8_t pitch) const
+{
+    if(pattern == nullptr || !_hasPattern) {
+        return pattern == nullptr && !_hasPattern;
+    }
+    return _pitch == pitch && memcmp(_pattern, pattern, PATTERN_SIZE) == 0;
+}
+
+// Queues the emulation thread's view of the sound.
+void Audio::push(float offset)
+{
+    auto head = _head.load(std::memory_order_relaxed);
+    if(head - _tail.load(std::memory_order_acquire) == EVENTS) {
+        _pending = true;
+        return;
+    }
+    auto fraction = static_cast<uint64_t>(std::min(std::max(offset, 0.0f), 1.0f) * _sampleRate);
+    auto& event = _events[head % EVENTS];
+    event.time = (_frame * _sampleRate + fraction) / 60;
+    event.step = _hasPattern ? patternStep(_pitch, _sampleRate) : phaseStep(FREQUENCY, _sampleRate);
+    event.on = _playing;
+    event.hasPattern = _hasPattern;
+    memcpy(event.pattern, _pattern, PATTERN_SIZE);
+    _head.store(head + 1, std::memory_order_release);
+    _pending = false;
+}
+
+void Audio::apply(const Event& event)
+{
+    if(event.on && !_on) {
+        _phase = 0;
+    }
+    _on = event.on;
+    _step = event.step;
+    for(int i = 0; i < LEVELS; i++) {
+        bool high = event.hasPattern
+            ? (event.pattern[i / 8] >> (7 - i % 8)) & 1
+            : i < LEVELS / 2;
+        _levels[i] = high ? AMPLITUDE : -AMPLITUDE;
+    }
+}
+
+void Audio::mix(int16_t* samples, int count)
+{
+    auto head = _head.load(std::memory_order_acquire);
+    auto tail = _tail.load(std::memory_order_relaxed);
+    int i = 0;
+    while(i < count) {
+        // the sound holds until the next change
+        int end = count;
+        if(tail != head) {
+            auto& event = _events[tail % EVENTS];
+            auto at = static_cast<int64_t>(event.time) + _offset - static_cast<int64_t>(_clock);
+            if(at < i || at >= 2 * count) {
+                // Late, so this and every later change is played that much
+                // later, or the guest clock ran more than a buffer ahead of
+                // the device.
+                _offset += i - at;
+                at = i;
+            }
+            if(at == i) {
+                apply(event);
+                tail++;
+                continue;
+            }
+            end = static_cast<int>(std::min<int64_t>(at, count));
+        }
+        if(_on) {
+            _phase = resample(_levels, _phase, _step, samples + i, end - i);
+        } else {
+            std::fill(samples + i, samples + end, 0);
+        }
+        i = end;
+    }
+    _tail.store(tail, std::memory_order_release);
+    _clock += count;
+}
+
+static void put(FILE* file, uint32_t value, int bytes)
+{
+    for(int i = 0; i < bytes; i++) {
+        fputc(static_cast<int>((value >> (i * 8)) & 0xFF), file);
+    }
+}
+
+bool Chip8::writeWav(char const* filename, const std::vector<int16_t>& samples, int sampleRate)
+{
+    auto file = fopen(filename, "wb");
+    if(file == nullptr) {
+        printf("Could not open %s for writing\n", filename);
+        return false;
+    }
+    uint32_t dataBytes = static_cast<uint32_t>(samples.size() * 2);
+    fputs("RIFF", file);
+    put(file, 36 + dataBytes, 4);
+    fputs("WAVEfmt ", file);
+    put(file, 16, 4);
+    // PCM, mono, 16 bits
+    put(file, 1, 2);
+    put(file, 1, 2);
+    put(file, static_cast<uint32_t>(sampleRate), 4);
+    put(file, static_cast<uint32_t>(sampleRate) * 2, 4);
+    put(file, 2, 2);
+    put(file, 16, 2);
+    fputs("data", file);
+    put(file, dataBytes, 4);
+    for(auto sample : samples) {
+        put(file, static_cast<uint16_t>(sample), 2);
+    }
+    auto failed = ferror(file) != 0;
+    fclose(file);
+    return !failed;
+}
@@ -0,0 +1,596 @@
+#include "chip8/batch_cpu.h"
+#include "chip8/cpu.h"
+#include "chip8/decoder.h"
+#include "chip8/registers.h"
+#include "chip8/display.h"
+#include "chip8/keyboard.h"
+
+using namespace std;
+using namespace Chip8;
+
+// The lane loops below are plain loops over the lane arrays. On x86-64
+// Linux they are built once for AVX2 and once for the SSE2 baseline, and
+// the loader picks the version the host supports.
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define CHIP8_LANE_KERNEL __attribute__((target_clones("avx2", "default")))
+#endif
+#endif
+#if !defined(CHIP8_LANE_KERNEL)
+#define CHIP8_LANE_KERNEL
+#endif
+
+// A group needs at least 1/MIN_GROUP_FRACTION of all lanes to be stepped
+// with the vector kernels, otherwise it finishes its frame on the scalar
+// CPUs.
+static const size_t MIN_GROUP_FRACTION = 16;
+
+// Lanes are padded to a whole number of AVX2 registers.
+static const size_t LANE_ALIGNMENT = 32;
+
+namespace {
+    struct LaneArrays {
+        uint8_t* v;
+        size_t stride;
+        uint16_t* pc;
+        uint16_t* index;
+        uint8_t* delayTimer;
+        uint8_t* soundTimer;
+        int32_t* microSeconds;
+        uint64_t* instructionCount;
+        uint8_t* running;
+        const uint8_t* mask;
+        // see Timing::instructionCost
+        int32_t instructionCost;
+        // see Quirks::shiftUsesVy
+        bool shiftUsesVy;
+    };
+}
+
+// Picks value for lanes in the mask and keeps old for the others, without
+// a branch so that the loops stay vectorizable.
+template<typename T>
+static inline T select(uint8_t mask, T value, T old)
+{
+    T m = static_cast<T>(-static_cast<T>(mask & 1));
+    return static_cast<T>((value & m) | (old & ~m));
+}
+
+// Charges the cost of an instruction to every lane in the mask and moves
+// it to the next PC.
+static inline void retire(const LaneArrays& lanes, size_t begin, size_t end, uint16_t next, int cost)
+{
+    auto mask = lanes.mask;
+    auto pc = lanes.pc;
+    auto microSeconds = lanes.microSeconds;
+    auto instructionCount = lanes.instructionCount;
+    auto running = lanes.running;
+    int32_t charge = lanes.instructionCost != 0 ? lanes.instructionCost : cost;
+    for(size_t i = begin; i < end; i++) {
+        uint8_t m = mask[i];
+        int32_t remaining = microSeconds[i] - (charge & -(m & 1));
+        pc[i] = select(m, next, pc[i]);
+        microSeconds[i] = remaining;
+        instructionCount[i] += m & 1;
+        running[i] = select(m, static_cast<uint8_t>(remaining > 0), running[i]);
+    }
+}
+
+// Skip instructions cost 55 cycles (73 for 9XY0) when they skip and 9
+// more when they don't, unless every instruction costs the same.
+static inline void retireSkip(const LaneArrays& lanes, size_t begin, size_t end, uint16_t at, const uint8_t* skip, int cost)
+{
+    auto mask = lanes.mask;
+    auto pc = lanes.pc;
+    auto microSeconds = lanes.microSeconds;
+    auto instructionCount = lanes.instructionCount;
+    auto running = lanes.running;
+    uint16_t skipped = at + 4;
+    uint16_t next = at + 2;
+    int32_t charge = lanes.instructionCost != 0 ? lanes.instructionCost : cost;
+    int32_t notSkipping = lanes.instructionCost != 0 ? 0 : 9;
+    for(size_t i = begin; i < end; i++) {
+        uint8_t m = mask[i];
+        uint8_t s = skip[i];
+        int32_t remaining = microSeconds[i] - ((charge + notSkipping - notSkipping * s) & -(m & 1));
+        pc[i] = select(m, select(s, skipped, next), pc[i]);
+        microSeconds[i] = remaining;
+        instructionCount[i] += m & 1;
+        running[i] = select(m, static_cast<uint8_t>(remaining > 0), running[i]);
+    }
+}
+
+static bool isSkip(Op op)
+{
+    return op == Op::SkipIfVxEqualsNn || op == Op::SkipIfVxNotEqualsNn
+        || op == Op::SkipIfVxEqualsVy || op == Op::SkipIfVxNotEqualsVy;
+}
+
+static bool isLongLoad(Memory& memory, uint16_t addr)
+{
+    return memory.get(addr) == 0xF0 && memory.get(addr + 1) == 0x00;
+}
+
+// Runs the instruction at pc on every lane in the mask between begin and
+// end, with the same results and cycle costs as CPU::execute. Returns
+// false if there is no kernel for the instruction.
+CHIP8_LANE_KERNEL
+static bool executeLanes(const LaneArrays& lanes, size_t begin, size_t end, uint16_t pc, const Instruction& instruction, uint8_t* skip)
+{
+    auto mask = lanes.mask;
+    auto vx = lanes.v + instruction.x * lanes.stride;
+    auto vy = lanes.v + instruction.y * lanes.stride;
+    auto vf = lanes.v + 0xF * lanes.stride;
+    auto shifted = lanes.shiftUsesVy ? vy : vx;
+    auto nn = instruction.nn;
+    auto nnn = instruction.nnn;
+    auto index = lanes.index;
+    auto delayTimer = lanes.delayTimer;
+    auto soundTimer = lanes.soundTimer;
+    uint16_t next = pc + 2;
+
+    switch(instruction.op) {
+        // 0x1NNN
+        case Op::Jump:
+            retire(lanes, begin, end, nnn, 105);
+            return true;
+        // 0x6XNN
+        case Op::SetRegisterVxToNn:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], nn, vx[i]);
+            }
+            retire(lanes, begin, end, next, 27);
+            return true;
+        // 0x7XNN
+        case Op::AddNnToRegisterVx:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], static_cast<uint8_t>(vx[i] + nn), vx[i]);
+            }
+            retire(lanes, begin, end, next, 45);
+            return true;
+        // 0x8XY0
+        case Op::SetVxToValueOfVy:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], vy[i], vx[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY1
+        case Op::BinaryOr:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], static_cast<uint8_t>(vx[i] | vy[i]), vx[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY2
+        case Op::BinaryAnd:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], static_cast<uint8_t>(vx[i] & vy[i]), vx[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY3
+        case Op::BinaryXor:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], static_cast<uint8_t>(vx[i] ^ vy[i]), vx[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY4, VF is written first so that VX wins when X is F
+        case Op::AddWithCarry:
+            for(size_t i = begin; i < end; i++) {
+                uint8_t x = vx[i];
+                uint8_t y = vy[i];
+                uint8_t sum = x + y;
+                uint8_t carry = sum < x;
+                vf[i] = select(mask[i], carry, vf[i]);
+                vx[i] = select(mask[i], sum, vx[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY5, VF is written last so that it wins when X is F
+        case Op::SubtractVyFromVx:
+            for(size_t i = begin; i < end; i++) {
+                uint8_t x = vx[i];
+                uint8_t y = vy[i];
+                uint8_t borrow = x > y;
+                vx[i] = select(mask[i], static_cast<uint8_t>(x - y), vx[i]);
+                vf[i] = select(mask[i], borrow, vf[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY6
+        case Op::ShiftRight:
+            for(size_t i = begin; i < end; i++) {
+                uint8_t x = shifted[i];
+                vx[i] = select(mask[i], static_cast<uint8_t>(x >> 1), vx[i]);
+                vf[i] = select(mask[i], static_cast<uint8_t>(x & 0x1), vf[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XY7
+        case Op::SubtractVxFromVy:
+            for(size_t i = begin; i < end; i++) {
+                uint8_t x = vx[i];
+                uint8_t y = vy[i];
+                uint8_t flag = y > x;
+                vx[i] = select(mask[i], static_cast<uint8_t>(y - x), vx[i]);
+                vf[i] = select(mask[i], flag, vf[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x8XYE
+        case Op::ShiftLeft:
+            for(size_t i = begin; i < end; i++) {
+                uint8_t x = shifted[i];
+                vx[i] = select(mask[i], static_cast<uint8_t>(x << 1), vx[i]);
+                vf[i] = select(mask[i], static_cast<uint8_t>(x >> 7), vf[i]);
+            }
+            retire(lanes, begin, end, next, 200);
+            return true;
+        // 0x3XNN
+        case Op::SkipIfVxEqualsNn:
+            for(size_t i = begin; i < end; i++) {
+                skip[i] = vx[i] == nn;
+            }
+            retireSkip(lanes, begin, end, pc, skip, 55);
+            return true;
+        // 0x4XNN
+        case Op::SkipIfVxNotEqualsNn:
+            for(size_t i = begin; i < end; i++) {
+                skip[i] = vx[i] != nn;
+            }
+            retireSkip(lanes, begin, end, pc, skip, 55);
+            return true;
+        // 0x5XY0
+        case Op::SkipIfVxEqualsVy:
+            for(size_t i = begin; i < end; i++) {
+                skip[i] = vx[i] == vy[i];
+            }
+            retireSkip(lanes, begin, end, pc, skip, 55);
+            return true;
+        // 0x9XY0
+        case Op::SkipIfVxNotEqualsVy:
+            for(size_t i = begin; i < end; i++) {
+                skip[i] = vx[i] != vy[i];
+            }
+            retireSkip(lanes, begin, end, pc, skip, 73);
+            return true;
+        // 0xANNN
+        case Op::SetIndexRegister:
+            for(size_t i = begin; i < end; i++) {
+                index[i] = select(mask[i], nnn, index[i]);
+            }
+            retire(lanes, begin, end, next, 55);
+            return true;
+        // 0xFX1E
+        case Op::AddToIndex:
+            for(size_t i = begin; i < end; i++) {
+                index[i] = select(mask[i], static_cast<uint16_t>(index[i] + vx[i]), index[i]);
+            }
+            retire(lanes, begin, end, next, 86);
+            return true;
+        // 0xFX29
+        case Op::FontCharacter:
+            for(size_t i = begin; i < end; i++) {
+                index[i] = select(mask[i], static_cast<uint16_t>(SPRITE_CHARS_ADDR + vx[i]), index[i]);
+            }
+            retire(lanes, begin, end, next, 91);
+            return true;
+        // 0xFX07
+        case Op::GetDelayTimer:
+            for(size_t i = begin; i < end; i++) {
+                vx[i] = select(mask[i], delayTimer[i], vx[i]);
+            }
+            retire(lanes, begin, end, next, 45);
+            return true;
+        // 0xFX15
+        case Op::SetDelayTimer:
+            for(size_t i = begin; i < end; i++) {
+                delayTimer[i] = select(mask[i], vx[i], delayTimer[i]);
+            }
+            retire(lanes, begin, end, next, 45);
+            return true;
+        // 0xFX18
+        case Op::SetSoundTimer:
+            for(size_t i = begin; i < end; i++) {
+                soundTimer[i] = select(mask[i], vx[i], soundTimer[i]);
+            }
+            retire(lanes, begin, end, next, 45);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Selects the running lanes at the given PC. Returns how many there are.
+CHIP8_LANE_KERNEL
+static size_t selectLanes(const LaneArrays& lanes, size_t begin, size_t end, uint16_t pc, uint8_t* mask)
+{
+    auto running = lanes.running;
+    auto pcs = lanes.pc;
+    size_t count = 0;
+    for(size_t i = begin; i < end; i++) {
+        uint8_t m = (running[i] & (pcs[i] == pc)) ? 0xFF : 0x00;
+        mask[i] = m;
+        count += m & 1;
+    }
+    return count;
+}
+
+void BatchCPU::WriteTracker::onMemoryWritten(uint16_t addr, uint16_t length)
+{
+    _batch.markWritten(_lane, addr, length);
+}
+
+BatchCPU::BatchCPU(size_t lanes)
+    : _stride((lanes + LANE_ALIGNMENT - 1) / LANE_ALIGNMENT * LANE_ALIGNMENT)
+    , _v(REGISTER_COUNT * _stride, 0)
+    , _pc(_stride, PROGRAM_START_ADDRESS)
+    , _index(_stride, 0)
+    , _delayTimer(_stride, 0)
+    , _soundTimer(_stride, 0)
+    , _microSeconds(_stride, 0)
+    , _instructionCount(_stride, 0)
+    , _running(_stride, 0)
+    , _mask(_stride, 0)
+    , _skip(_stride, 0)
+    , _timing(Timing::vip())
+    , _quirks()
+    , _written(lanes * CHUNKS / 64, 0)
+    , _writtenLanes()
+{
+    _lanes.resize(lanes);
+    for(size_t i = 0; i < lanes; i++) {
+        auto& lane = _lanes[i];
+        lane.memory = make_shared<Memory>();
+        lane.registers = make_shared<Registers>();
+        lane.cpu = make_unique<CPU>(lane.memory, lane.registers);
+        lane.cpu->setBlockExecution(false);
+        lane.display = make_shared<Display>();
+        lane.keyboard = make_shared<Keyboard>();
+        lane.tracker = make_unique<WriteTracker>(*this, i);
+        lane.memory->addObserver(lane.tracker.get());
+    }
+}
+
+BatchCPU::~BatchCPU()
+{
+    for(auto& lane : _lanes) {
+        lane.memory->removeObserver(lane.tracker.get());
+    }
+}
+
+RomError BatchCPU::loadROM(char const* filename)
+{
+    Rom rom;
+    auto error = rom.open(filename);
+    return error != RomError::None ? error : loadROM(rom.data(), rom.size());
+}
+
+RomError BatchCPU::loadROM(const uint8_t* data, size_t length)
+{
+    auto error = RomError::None;
+    for(auto& lane : _lanes) {
+        error = lane.memory->loadROM(data, length);
+        if(error != RomError::None) {
+            break;
+        }
+    }
+    clearWritten();
+    return error;
+}
+
+Memory& BatchCPU::getMemory(size_t lane)
+{
+    return *_lanes[lane].memory;
+}
+
+Display& BatchCPU::getDisplay(size_t lane)
+{
+    return *_lanes[lane].display;
+}
+
+Keyboard& BatchCPU::getKeyboard(size_t lane)
+{
+    return *_lanes[lane].keyboard;
+}
+
+void BatchCPU::setTiming(const Timing& timing)
+{
+    _timing = timing;
+    for(auto& lane : _lanes) {
+        lane.cpu->setTiming(timing);
+    }
+}
+
+void BatchCPU::setQuirks(const Quirks& quirks)
+{
+    _quirks = quirks;
+    for(auto& lane : _lanes) {
+        lane.cpu->setQuirks(quirks);
+    }
+}
+
+void BatchCPU::seedRandom(size_t lane, unsigned int seed)
+{
+    _lanes[lane].cpu->seedRandom(seed);
+}
+
+uint64_t BatchCPU::getInstructionCount() const
+{
+    uint64_t count = 0;
+    for(size_t i = 0; i < _lanes.size(); i++) {
+        count += _instructionCount[i];
+    }
+    return count;
+}
+
+void BatchCPU::markWritten(size_t lane, uint16_t addr, uint16_t length)
+{
+    auto last = min<size_t>(addr + length - 1, XO_RAM_SIZE - 1) / CHUNK_SIZE;
+    for(size_t chunk = addr / CHUNK_SIZE; chunk <= last; chunk++) {
+        auto& word = _written[lane * CHUNKS / 64 + chunk / 64];
+        auto bit = uint64_t(1) << (chunk % 64);
+        if((word & bit) == 0) {
+            word |= bit;
+            _writtenLanes[chunk]++;
+        }
+    }
+}
+
+void BatchCPU::clearWritten()
+{
+    fill(_written.begin(), _written.end(), 0);
+    fill(begin(_writtenLanes), end(_writtenLanes), 0);
+}
+
+bool BatchCPU::isWritten(size_t lane, uint16_t addr) const
+{
+    auto chunk = chunkOf(addr);
+    return (_written[lane * CHUNKS / 64 + chunk / 64] >> (chunk % 64)) & 1;
+}
+
+void BatchCPU::tick()
+{
+    auto lanes = _lanes.size();
+    for(size_t i = 0; i < lanes; i++) {
+        _lanes[i].keyboard->update();
+        _delayTimer[i] -= _delayTimer[i] > 0 ? 1 : 0;
+        _soundTimer[i] -= _soundTimer[i] > 0 ? 1 : 0;
+        while(_microSeconds[i] <= 0) {
+            _microSeconds[i] += _timing.frameBudget;
+        }
+        _running[i] = 1;
+    }
+
+    LaneArrays arrays {
+        _v.data(), _stride, _pc.data(), _index.data(),
+        _delayTimer.data(), _soundTimer.data(), _microSeconds.data(),
+        _instructionCount.data(), _running.data(), _mask.data(),
+        _timing.instructionCost,
+        _quirks.shiftUsesVy
+    };
+    // lanes before the leader have finished the frame
+    size_t leader = 0;
+    while(true) {
+        while(leader < lanes && !_running[leader]) {
+            leader++;
+        }
+        if(leader == lanes) {
+            break;
+        }
+
+        auto pc = _pc[leader];
+        auto count = selectLanes(arrays, leader, lanes, pc, _mask.data());
+        if(count * MIN_GROUP_FRACTION < lanes) {
+            for(size_t i = leader; i < lanes; i++) {
+                if(_mask[i]) {
+                    finishScalar(i);
+                }
+            }
+            continue;
+        }
+
+        auto& memory = *_lanes[leader].memory;
+        uint16_t opcode = (memory.get(pc) << 8) | memory.get(pc + 1);
+        if(_writtenLanes[chunkOf(pc)] > 0 || _writtenLanes[chunkOf(pc + 1)] > 0) {
+            dropDifferentCode(leader, opcode);
+        }
+
+        auto instruction = Decoder::decodeInstruction(opcode);
+        // a skip over XO-CHIP's four byte F000 NNNN, in any lane, is left to
+        // the scalar CPUs
+        auto skipsLongLoad = isSkip(instruction.op)
+            && (isLongLoad(memory, pc + 2) || _writtenLanes[chunkOf(pc + 2)] > 0 || _writtenLanes[chunkOf(pc + 3)] > 0);
+        if(!skipsLongLoad && executeLanes(arrays, leader, lanes, pc, instruction, _skip.data())) {
+            continue;
+        }
+        // FX0A spins on itself until a key is released, which is cheaper to
+        // do on the scalar CPU than one vector step per iteration
+        auto waiting = instruction.op == Op::GetKey;
+        for(size_t i = leader; i < lanes; i++) {
+            if(_mask[i]) {
+                if(waiting) {
+                    finishScalar(i);
+                } else {
+                    stepScalar(i);
+                }
+            }
+        }
+    }
+}
+
+// Removes the lanes whose own memory holds a different opcode at the PC
+// from the current group. They form a group of their own later.
+void BatchCPU::dropDifferentCode(size_t leader, uint16_t opcode)
+{
+    auto pc = _pc[leader];
+    auto leaderWritten = isWritten(leader, pc) || isWritten(leader, pc + 1);
+    for(size_t i = leader + 1; i < _lanes.size(); i++) {
+        if(!_mask[i] || (!leaderWritten && !isWritten(i, pc) && !isWritten(i, pc + 1))) {
+            continue;
+        }
+        auto& memory = *_lanes[i].memory;
+        if(((memory.get(pc) << 8) | memory.get(pc + 1)) != opcode) {
+            _mask[i] = 0;
+        }
+    }
+}
+
+// Runs one instruction on the lane's CPU.
+void BatchCPU::stepScalar(size_t lane)
+{
+    loadLane(lane);
+    _instructionCount[lane]++;
+    auto delta = _lanes[lane].cpu->emulateCycle(_lanes[lane].display, _lanes[lane].keyboard);
+    storeLane(lane);
+    if(delta == 0) {
+        _running[lane] = 0;
+        return;
+    }
+    _microSeconds[lane] -= _timing.cost(delta);
+    _running[lane] = _microSeconds[lane] > 0;
+}
+
+// Runs the rest of the lane's frame on its CPU, like CPU::tick does.
+void BatchCPU::finishScalar(size_t lane)
+{
+    loadLane(lane);
+    auto& cpu = *_lanes[lane].cpu;
+    auto before = cpu.getInstructionCount();
+    cpu.run(_lanes[lane].display.get(), _lanes[lane].keyboard.get());
+    _instructionCount[lane] += cpu.getInstructionCount() - before;
+    storeLane(lane);
+    _running[lane] = 0;
+}
+
+void BatchCPU::loadLane(size_t lane)
+{
+    auto& cpu = *_lanes[lane].cpu;
+    auto state = cpu.getState();
+    state.pc = _pc[lane];
+    state.index = _index[lane];
+    state.delayTimer = _delayTimer[lane];
+    state.soundTimer = _soundTimer[lane];
+    state.microSeconds = _microSeconds[lane];
+    cpu.setState(state);
+    auto registers = _lanes[lane].registers->data();
+    for(uint8_t r = 0; r < REGISTER_COUNT; r++) {
+        registers[r] = _v[r * _stride + lane];
+    }
+}
+
+void BatchCPU::storeLane(size_t lane)
+{
+    auto& state = _lanes[lane].cpu->getState();
+    _pc[lane] = state.pc;
+    _index[lane] = state.index;
+    _delayTimer[lane] = state.delayTimer;
+    _soundTimer[lane] = state.soundTimer;
+    _microSeconds[lane] = state.microSeconds;
+    auto registers = _lanes[lane].registers->data();
+    for(uint8_t r = 0; r < REGISTER_COUNT; r++) {
+        _v[r * _stride + lane] = registers[r];
+    }
+}
@@ -0,0 +1,85 @@
+#include "chip8/block_cache.h"
+
+using namespace Chip8;
+
+static bool endsBlock(Op op)
+{
+    switch (op)
+    {
+        case Op::Invalid:
+        case Op::Return:
+        case Op::ReturnFromSubroutine:
+        case Op::Jump:
+        case Op::JumpToSubroutine:
+        case Op::JumpWithOffset:
+        case Op::SkipIfVxEqualsNn:
+        case Op::SkipIfVxNotEqualsNn:
+        case Op::SkipIfVxEqualsVy:
+        case Op::SkipIfVxNotEqualsVy:
+        case Op::SkipIfKeyPressed:
+        case Op::SkipIfNotKeyPressed:
+        case Op::GetKey:
+        case Op::StoreRegistersToMemory:
+        case Op::BinaryCodeDecimalConversion:
+        // followed by its address rather than an instruction
+        case Op::LoadLongIndex:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void BlockCache::build(uint16_t pc, Memory& memory)
+{
+    auto& block = _blocks[pc >> 1];
+    if(block == nullptr) {
+        block = std::make_unique<Block>();
+        block->successors[0] = nullptr;
+        block->successors[1] = nullptr;
+    }
+    block->start = pc;
+    block->length = 0;
+    block->nextSuccessor = 0;
+
+    auto addr = pc;
+    while(block->length < Block::MAX_LENGTH && addr + 1 < RAM_SIZE) {
+        auto& instruction = block->instructions[block->length++];
+        instruction = Decoder::decodeInstruction(memory.get(addr) << 8 | memory.get(addr + 1));
+        addr += 2;
+        if(endsBlock(instruction.op)) {
+            break;
+        }
+    }
+    block->end = addr;
+    block->valid = true;
+}
+
+void BlockCache::invalidate()
+{
+    for (auto& block : _blocks) {
+        if(block != nullptr) {
+            block->valid = false;
+        }
+    }
+}
+
+void BlockCache::onMemoryWritten(uint16_t addr, uint16_t length)
+{
+    // only blocks starting at most MAX_LENGTH instructions before the
+    // written range can overlap it
+    int first = (addr - Block::MAX_LENGTH * 2) >> 1;
+    if(first < 0) {
+        first = 0;
+    }
+    int last = (addr + length - 1) >> 1;
+    if(last >= SLOTS) {
+        last = SLOTS - 1;
+    }
+    uint32_t end = addr + length;
+    for (int slot = first; slot <= last; slot++) {
+        auto& block = _blocks[slot];
+        if(block != nullptr && block->valid && block->start < end && block->end > addr) {
+            block->valid = false;
+        }
+    }
+}
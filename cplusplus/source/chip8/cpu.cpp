@@ -1,160 +1,348 @@
 #include "chip8/cpu.h"
+#include "chip8/decoder.h"
 #include "chip8/display.h"
 #include "chip8/keyboard.h"
 #include "chip8/audio.h"
 #include "chip8/memory.h"
 #include "chip8/registers.h"
+#include "chip8/trace.h"
 
 using namespace std;
 using namespace Chip8;
 
 void CPU::tick(
-    shared_ptr<Display> display, 
-    shared_ptr<Keyboard> keyboard, 
-    shared_ptr<Audio> audio)
+    const shared_ptr<Display>& display, 
+    const shared_ptr<Keyboard>& keyboard, 
+    const shared_ptr<Audio>& audio)
 {
-    printf("CPU TICK!\n");
-    if(_delayTimer > 0) {
-        _delayTimer--;
+    CHIP8_TRACE(Debug, Fetch, "CPU TICK!");
+    if(_state.delayTimer > 0) {
+        _state.delayTimer--;
     }
-    if(_soundTimer > 0) {
-        if(!audio->isPlaying()) {
-            audio->play();
-        }
-        _soundTimer--;        
-    } else {
-        if(audio != nullptr && audio->isPlaying()) {
-            audio->pause();
-        }
+    if(_state.soundTimer > 0) {
+        _state.soundTimer--;
     }
 
-    while(_microSeconds <= 0) {
-        _microSeconds += 16666;
+    while(_state.microSeconds <= 0) {
+        _state.microSeconds += _timing.frameBudget;
+    }
+    auto budget = _state.microSeconds;
+    if(audio != nullptr) {
+        audio->beginFrame();
+        updateSound(*audio, 0.0f);
     }
-    while(_microSeconds > 0) {
-        auto delta = emulateCycle(display, keyboard);
+    _soundWrittenAt = budget;
+    if(!run(display.get(), keyboard.get())) {
+        CHIP8_TRACE(Error, Decode, "Break tick loop at %#04x", _state.pc - 2);
+    }
+    if(audio != nullptr) {
+        // FX18, F002 and FX3A change the sound as soon as they run, not at
+        // the next frame
+        updateSound(*audio, static_cast<float>(budget - _soundWrittenAt) / budget);
+    }
+}
+
+// The beeper sounds while the sound timer is above zero.
+void CPU::updateSound(Audio& audio, float offset)
+{
+    auto pattern = _state.hasPattern ? _state.pattern : nullptr;
+    if(!audio.playsPattern(pattern, _state.pitch)) {
+        audio.setPattern(pattern, _state.pitch, offset);
+    }
+    auto sounding = _state.soundTimer > 0;
+    if(sounding && !audio.isPlaying()) {
+        audio.play(offset);
+    } else if(!sounding && audio.isPlaying()) {
+        audio.pause(offset);
+    }
+}
+
+bool CPU::run(Display* display, Keyboard* keyboard)
+{
+    return (this->*_run)(display, keyboard);
+}
+
+void CPU::setQuirks(const Quirks& quirks)
+{
+    _quirks = quirks;
+    _memory->setSize(quirks.memorySize);
+    specialize(make_index_sequence<Quirks::COMBINATIONS>(), quirks.getMask());
+#if defined(CHIP8_JIT_ENABLED)
+    _recompiler.setShiftUsesVy(quirks.shiftUsesVy);
+#endif
+}
+
+template<size_t... QUIRKS>
+void CPU::specialize(index_sequence<QUIRKS...>, uint8_t mask)
+{
+    static const RunFunction RUN[] = { &CPU::runInstructions<QUIRKS>... };
+    static const ExecuteFunction EXECUTE[] = { &CPU::execute<QUIRKS>... };
+    _run = RUN[mask];
+    _execute = EXECUTE[mask];
+}
+
+template<uint8_t QUIRKS>
+bool CPU::runInstructions(Display* display, Keyboard* keyboard)
+{
+    if(_blockExecution) {
+        return runBlocks<QUIRKS>(display, keyboard);
+    }
+    while(_state.microSeconds > 0) {
+        _instructionCount++;
+        auto& instruction = _instructionCache.fetch(_state.pc, *_memory);
+        _state.pc += 2;
+        auto delta = execute<QUIRKS>(instruction, display, keyboard);
         if(delta == 0) {
-            printf( "Break tick loop: \n" );
-            break;
+            return false;
         }
-        _microSeconds -= delta;
+        _state.microSeconds -= _timing.cost(delta);
     }
+    return true;
 }
 
-int CPU::emulateCycle(
-    shared_ptr<Display> display,
-    shared_ptr<Keyboard> keyboard)
+void CPU::setTiming(const Timing& timing)
 {
-    auto opcode = getOpcode();
-    return execute(opcode, display, keyboard);    
+    _timing = timing;
+#if defined(CHIP8_JIT_ENABLED)
+    _recompiler.setInstructionCost(timing.instructionCost);
+#endif
 }
 
-uint16_t CPU::getOpcode()
+// Runs chained basic blocks until the cycle budget of the current frame is
+// spent. Returns false if an invalid opcode was hit.
+template<uint8_t QUIRKS>
+bool CPU::runBlocks(Display* display, Keyboard* keyboard)
 {
-    auto opcode = _memory->get(_pc) << 8 | _memory->get(_pc + 1);
-    _pc += 2;
-    return opcode;
+    Block* previous = nullptr;
+    while(_state.microSeconds > 0) {
+        if(_recompilation && runRecompiled()) {
+            previous = nullptr;
+            continue;
+        }
+
+        auto block = previous != nullptr
+            ? _blockCache.next(previous, _state.pc, *_memory)
+            : _blockCache.lookup(_state.pc, *_memory);
+        if(block == nullptr) {
+            // blocks only start at even addresses
+            auto& instruction = _instructionCache.fetch(_state.pc, *_memory);
+            _state.pc += 2;
+            _instructionCount++;
+            auto delta = execute<QUIRKS>(instruction, display, keyboard);
+            if(delta == 0) {
+                return false;
+            }
+            _state.microSeconds -= _timing.cost(delta);
+            previous = nullptr;
+            continue;
+        }
+
+        for(uint8_t i = 0; i < block->length; i++) {
+            _state.pc += 2;
+            _instructionCount++;
+            auto delta = execute<QUIRKS>(block->instructions[i], display, keyboard);
+            if(delta == 0) {
+                return false;
+            }
+            _state.microSeconds -= _timing.cost(delta);
+            if(_state.microSeconds <= 0) {
+                return true;
+            }
+        }
+        previous = block;
+    }
+    return true;
+}
+
+// Runs the recompiled region at the program counter, if there is one.
+bool CPU::runRecompiled()
+{
+#if defined(CHIP8_JIT_ENABLED)
+    auto code = _recompiler.lookup(_state.pc, *_memory);
+    if(code == nullptr) {
+        return false;
+    }
+    JitState jitState;
+    jitState.v = _registers->data();
+    jitState.index = _state.index;
+    jitState.pc = _state.pc;
+    jitState.microSeconds = _state.microSeconds;
+    jitState.instructionCount = _instructionCount;
+    jitState.delayTimer = _state.delayTimer;
+    jitState.soundTimer = _state.soundTimer;
+    code(&jitState);
+    _state.index = jitState.index;
+    _state.pc = jitState.pc;
+    _state.microSeconds = jitState.microSeconds;
+    _instructionCount = jitState.instructionCount;
+    _state.delayTimer = jitState.delayTimer;
+    _state.soundTimer = jitState.soundTimer;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int CPU::emulateCycle(
+    const shared_ptr<Display>& display,
+    const shared_ptr<Keyboard>& keyboard)
+{
+    _instructionCount++;
+    auto& instruction = _instructionCache.fetch(_state.pc, *_memory);
+    _state.pc += 2;
+    return (this->*_execute)(instruction, display.get(), keyboard.get());
 }
 
+template<uint8_t QUIRKS>
 int CPU::execute(
-    uint16_t opcode,
-    shared_ptr<Display> display,
-    shared_ptr<Keyboard> keyboard)
+    const Instruction& instruction,
+    Display* display,
+    Keyboard* keyboard)
 {
-    uint8_t x = (opcode & 0x0F00) >> 8;
-    uint8_t y = (opcode & 0x00F0) >> 4;
+    auto x = instruction.x;
+    auto y = instruction.y;
 
-    uint8_t n = opcode & 0x000F;
-    uint8_t nn = opcode & 0x00FF;
-    uint16_t nnn = opcode & 0x0FFF;
+    auto n = instruction.n;
+    auto nn = instruction.nn;
+    auto nnn = instruction.nnn;
 
-    printf("OPCODE: %04X\n", opcode);
+    CHIP8_TRACE(Debug, Fetch, "OPCODE: %04X", instruction.opcode);
     
-    switch (opcode & 0xF000)
+    auto op = instruction.op;
+
+#if defined(CHIP8_DISPATCH_GOTO)
+    #define CHIP8_LABEL_ADDRESS(name) &&do##name,
+    static void* const LABELS[] = { CHIP8_OPS(CHIP8_LABEL_ADDRESS) };
+    #undef CHIP8_LABEL_ADDRESS
+    goto *LABELS[static_cast<uint8_t>(op)];
+    #define CHIP8_CASE(name) do##name:
+#else
+    switch (op)
     {
-        case 0x0000:
-            switch (opcode & 0x00FF)
-            {
-                case 0x00E0: return opClearScreen(display);
-                case 0x000E: return opReturn();
-                case 0x00EE: return opReturnFromSubroutine();
-            }
-        case 0x1000: return opJump(nnn);
-        case 0x2000: return opJumpToSubroutine(nnn);
-        case 0x3000: return opSkipIfVxEqualsNn(x, nn);
-        case 0x4000: return opSkipIfVxNotEqualsNn(x, nn);
-        case 0x5000: return opSkipIfVxEqualsVy(x, y);
-        case 0x6000: return opSetRegisterVxToNn(x, nn);
-        case 0x7000: return opAddNnToRegisterVx(x, nn);
-        case 0x8000:
-            switch (opcode & 0x000F) {
-                    case 0x0000: return opSetVxToValueOfVy(x, y);
-                    case 0x0001: return opBinaryOr(x, y);
-                    case 0x0002: return opBinaryAnd(x, y);
-                    case 0x0003: return opBinaryXor(x, y);
-                    case 0x0004: return opAddWithCarry(x, y);
-                    case 0x0005: return opSubtractVyFromVx(x, y);
-                    case 0x0006: return opShiftRight(x);
-                    case 0x0007: return opSubtractVxFromVy(x, y);
-                    case 0x000E: return opShiftLeft(x);
-            }
-        case 0x9000: return opSkipIfVxNotEqualsVy(x, y);
-        case 0xA000: return opSetIndexRegister(nnn);
-        case 0xB000: return opJumpWithOffset(nnn);
-        case 0xC000: return opRandom(x, nn);
-        case 0xD000: return opDisplay(x, y, n, display);
-        case 0xE000:
-            switch (opcode & 0x00FF) {
-                case 0x009E: return opSkipIfKeyPressed(x, keyboard);
-                case 0x00A1: return opSkipIfNotKeyPressed(x, keyboard);
-            }
-        case 0xF000:
-            switch (opcode & 0x00FF) {
-                case 0x0007: return opGetDelayTimer(x);
-                case 0x000A: return opGetKey(x, keyboard);
-                case 0x0015: return opSetDelayTimer(x);
-                case 0x0018: return opSetSoundTimer(x);
-                case 0x001E: return opAddToIndex(x);
-                case 0x0029: return opFontCharacter(x);
-                case 0x0033: return opBinaryCodeDecimalConversion(x);
-                case 0x0055: return opStoreRegistersToMemory(x);
-                case 0x0065: return opLoadRegistersFromMemory(x);
-            }
-        default: return 0;
-    }   
+    #define CHIP8_CASE(name) case Op::name:
+#endif
+        CHIP8_CASE(ClearScreen) return opClearScreen(display);
+        CHIP8_CASE(Return) return opReturn();
+        CHIP8_CASE(ReturnFromSubroutine) return opReturnFromSubroutine();
+        CHIP8_CASE(Jump) return opJump(nnn);
+        CHIP8_CASE(JumpToSubroutine) return opJumpToSubroutine(nnn);
+        CHIP8_CASE(SkipIfVxEqualsNn) return opSkipIfVxEqualsNn(x, nn);
+        CHIP8_CASE(SkipIfVxNotEqualsNn) return opSkipIfVxNotEqualsNn(x, nn);
+        CHIP8_CASE(SkipIfVxEqualsVy) return opSkipIfVxEqualsVy(x, y);
+        CHIP8_CASE(SetRegisterVxToNn) return opSetRegisterVxToNn(x, nn);
+        CHIP8_CASE(AddNnToRegisterVx) return opAddNnToRegisterVx(x, nn);
+        CHIP8_CASE(SetVxToValueOfVy) return opSetVxToValueOfVy(x, y);
+        CHIP8_CASE(BinaryOr) return opBinaryOr(x, y);
+        CHIP8_CASE(BinaryAnd) return opBinaryAnd(x, y);
+        CHIP8_CASE(BinaryXor) return opBinaryXor(x, y);
+        CHIP8_CASE(AddWithCarry) return opAddWithCarry(x, y);
+        CHIP8_CASE(SubtractVyFromVx) return opSubtractVyFromVx(x, y);
+        CHIP8_CASE(ShiftRight) return opShiftRight<(QUIRKS & Quirks::SHIFT_USES_VY) != 0>(x, y);
+        CHIP8_CASE(SubtractVxFromVy) return opSubtractVxFromVy(x, y);
+        CHIP8_CASE(ShiftLeft) return opShiftLeft<(QUIRKS & Quirks::SHIFT_USES_VY) != 0>(x, y);
+        CHIP8_CASE(SkipIfVxNotEqualsVy) return opSkipIfVxNotEqualsVy(x, y);
+        CHIP8_CASE(SetIndexRegister) return opSetIndexRegister(nnn);
+        CHIP8_CASE(JumpWithOffset) return opJumpWithOffset<(QUIRKS & Quirks::JUMP_USES_VX) != 0>(x, nnn);
+        CHIP8_CASE(Random) return opRandom(x, nn);
+        CHIP8_CASE(Display) return opDisplay<(QUIRKS & Quirks::SPRITES_WRAP) != 0 ? SpriteEdge::Wrap : SpriteEdge::Clip>(x, y, n, display);
+        CHIP8_CASE(SkipIfKeyPressed) return opSkipIfKeyPressed(x, keyboard);
+        CHIP8_CASE(SkipIfNotKeyPressed) return opSkipIfNotKeyPressed(x, keyboard);
+        CHIP8_CASE(GetDelayTimer) return opGetDelayTimer(x);
+        CHIP8_CASE(GetKey) return opGetKey(x, keyboard);
+        CHIP8_CASE(SetDelayTimer) return opSetDelayTimer(x);
+        CHIP8_CASE(SetSoundTimer) return opSetSoundTimer(x);
+        CHIP8_CASE(AddToIndex) return opAddToIndex(x);
+        CHIP8_CASE(FontCharacter) return opFontCharacter(x);
+        CHIP8_CASE(BinaryCodeDecimalConversion) return opBinaryCodeDecimalConversion(x);
+        CHIP8_CASE(StoreRegistersToMemory) return opStoreRegistersToMemory<(QUIRKS & Quirks::LOAD_STORE_INCREMENTS_INDEX) != 0>(x);
+        CHIP8_CASE(LoadRegistersFromMemory) return opLoadRegistersFromMemory<(QUIRKS & Quirks::LOAD_STORE_INCREMENTS_INDEX) != 0>(x);
+        CHIP8_CASE(LoadAudioPattern) return opLoadAudioPattern();
+        CHIP8_CASE(SetPitch) return opSetPitch(x);
+        CHIP8_CASE(ScrollDown) return opScrollDown(n, display);
+        CHIP8_CASE(ScrollRight) return opScrollRight(display);
+        CHIP8_CASE(ScrollLeft) return opScrollLeft(display);
+        CHIP8_CASE(LowResolution) return opSetResolution(false, display);
+        CHIP8_CASE(HighResolution) return opSetResolution(true, display);
+        CHIP8_CASE(LargeFontCharacter) return opLargeFontCharacter(x);
+        CHIP8_CASE(LoadLongIndex) return opLoadLongIndex();
+        CHIP8_CASE(SelectPlanes) return opSelectPlanes(x, display);
+        CHIP8_CASE(Invalid) return 0;
+    #undef CHIP8_CASE
+#if !defined(CHIP8_DISPATCH_GOTO)
+        case Op::Count: break;
+    }
+    return 0;
+#endif
 }
 
 // 0x1NNN
 int CPU::opJump(uint16_t nnn)
 {
-    printf("Jump to %#04x,\n", nnn);
-    _pc = nnn;
+    CHIP8_TRACE(Debug, Decode, "Jump to %#04x", nnn);
+    _state.pc = nnn;
     return 105;
 }
 
 // 0x00E0
-int CPU::opClearScreen(shared_ptr<Display> display)
+int CPU::opClearScreen(Display* display)
 {
-    printf("ClearScreen\n");
+    CHIP8_TRACE(Debug, Display, "ClearScreen");
     display->clear();
     return 109;
 }
 
+// 0x00CN, SUPER-CHIP
+int CPU::opScrollDown(uint8_t n, Display* display)
+{
+    CHIP8_TRACE(Debug, Display, "ScrollDown %d", n);
+    display->scrollDown(n);
+    display->setDrawFlag(true);
+    return 109;
+}
+
+// 0x00FB, SUPER-CHIP
+int CPU::opScrollRight(Display* display)
+{
+    CHIP8_TRACE(Debug, Display, "ScrollRight");
+    display->scrollRight(4);
+    display->setDrawFlag(true);
+    return 109;
+}
+
+// 0x00FC, SUPER-CHIP
+int CPU::opScrollLeft(Display* display)
+{
+    CHIP8_TRACE(Debug, Display, "ScrollLeft");
+    display->scrollLeft(4);
+    display->setDrawFlag(true);
+    return 109;
+}
+
+// 0x00FE and 0x00FF, SUPER-CHIP
+int CPU::opSetResolution(bool hires, Display* display)
+{
+    CHIP8_TRACE(Debug, Display, "SetResolution hires=%d", hires ? 1 : 0);
+    display->setHires(hires);
+    display->clearAll();
+    display->setDrawFlag(true);
+    return 109;
+}
+
 // 0x000E
 int CPU::opReturn()
 {
-    printf("Return,\n");
-    _pc = _index;
+    CHIP8_TRACE(Debug, Decode, "Return");
+    _state.pc = _state.index;
     return 1;
 }
 
 // 0x00EE
 int CPU::opReturnFromSubroutine()
 {
-    printf("Return from subroutine,\n");
-    if(_sp > 0) {
-        _sp--;
-        _pc = _stack[_sp];
+    CHIP8_TRACE(Debug, Decode, "Return from subroutine");
+    if(_state.sp > 0) {
+        _state.sp--;
+        _state.pc = _state.stack[_state.sp];
     }
     return 105;
 }
@@ -162,7 +350,7 @@ int CPU::opReturnFromSubroutine()
 // 0x6XNN
 int CPU::opSetRegisterVxToNn(uint8_t x, uint8_t nn)
 {
-    printf("Setting register %d to value: %d,\n", x, nn);
+    CHIP8_TRACE(Debug, Decode, "Setting register %d to value: %d", x, nn);
     _registers->set(x, nn);
     return 27;
 }
@@ -170,7 +358,7 @@ int CPU::opSetRegisterVxToNn(uint8_t x, uint8_t nn)
 // 0x7XNN
 int CPU::opAddNnToRegisterVx(uint8_t x, uint8_t nn)
 {
-    printf("opAddNnToRegsiterVx\n");
+    CHIP8_TRACE(Debug, Decode, "opAddNnToRegsiterVx");
     auto vx = _registers->get(x);
     auto vy = nn;
     while(vy != 0) {
@@ -185,80 +373,112 @@ int CPU::opAddNnToRegisterVx(uint8_t x, uint8_t nn)
 // 0xANNN
 int CPU::opSetIndexRegister(uint16_t nnn)
 {
-    printf("Setting register I to %04x\n", nnn);
-    _index = nnn;
+    CHIP8_TRACE(Debug, Decode, "Setting register I to %04x", nnn);
+    _state.index = nnn;
     return 55;
 }
 
 // 0xDXYN
-int CPU::opDisplay(uint8_t x, uint8_t y, uint8_t n, std::shared_ptr<Display> display)
+template<SpriteEdge EDGE>
+int CPU::opDisplay(uint8_t x, uint8_t y, uint8_t n, Display* display)
 {
-    auto index = _index;
     auto vx = _registers->get(x);
     auto vy = _registers->get(y);
-    auto rows = 32;
-    auto cols = 64;
-
-    printf("Rendering a %d pixel tall sprite at X: %d, Y: %d from the address: %d\n", n, vx, vy, index);
-
-    for(auto row = vy; row < vy + n; row++) {
-        auto startX = vx + row * cols;
-        auto endX = startX + 8;
-        uint8_t bitMask = 128;
-        for(auto col = startX; col < endX; col++) {
-            if((col % cols) >= (startX % cols)) {
-                auto position = (row * cols) + (col % cols);
-                if((_memory->get(index) & bitMask) == bitMask) {
-                    display->flipPixel(position);
-                }
-            }
-            bitMask /= 2;
-        }
-        index++;
+
+    CHIP8_TRACE(Debug, Display, "Rendering a %d pixel tall sprite at X: %d, Y: %d from the address: %d", n, vx, vy, _state.index);
+
+    // XO-CHIP reads one sprite after the other for each selected plane
+    uint8_t sprite[32 * PLANES];
+    // SUPER-CHIP draws 16x16 sprites in both resolutions, as Octo does
+    uint8_t length = (n == 0 ? 32 : n) * display->getSelectedPlaneCount();
+    for(uint8_t i = 0; i < length; i++) {
+        sprite[i] = _memory->get(_state.index + i);
     }
+    auto collision = n == 0
+        ? display->drawLargeSprite(vx, vy, sprite, EDGE)
+        : display->drawSprite(vx, vy, sprite, n, EDGE);
+    _registers->set(0xF, collision ? 1 : 0);
     display->setDrawFlag(true);
 
     return 22734;
 }
 
 // 0xFX0A
-int CPU::opGetKey(uint8_t x, shared_ptr<Keyboard> keyboard)
+int CPU::opGetKey(uint8_t x, Keyboard* keyboard)
 {
-	printf("opGetKey\n");
+	CHIP8_TRACE(Debug, Input, "opGetKey");
     for(auto i = 0; i < 16; i++) {
 		if(keyboard->hasBeenReleased(i)) {
 			_registers->set(x, i);
 			return 1;
 		}
 	}
-	_pc -= 2;
+	_state.pc -= 2;
+	// the VIP scans the keypad until the next interrupt, so waiting takes
+	// the rest of the frame under every timing model: leave exactly what
+	// this instruction costs in the budget
+	_state.microSeconds = _timing.cost(1);
 	return 1;
 }
 
 // 0xFX29
 int CPU::opFontCharacter(uint8_t x)
 {
-    printf("opFontCharacter\n");
-    _index = SPRITE_CHARS_ADDR + _registers->get(x);
+    CHIP8_TRACE(Debug, Decode, "opFontCharacter");
+    _state.index = SPRITE_CHARS_ADDR + _registers->get(x);
+    return 91;
+}
+
+// 0xFX30, SUPER-CHIP
+int CPU::opLargeFontCharacter(uint8_t x)
+{
+    CHIP8_TRACE(Debug, Decode, "opLargeFontCharacter");
+    _state.index = LARGE_SPRITE_CHARS_ADDR + (_registers->get(x) & 0xF) * 10;
     return 91;
 }
 
+// 0xF000 0xNNNN, XO-CHIP
+int CPU::opLoadLongIndex()
+{
+    CHIP8_TRACE(Debug, Decode, "opLoadLongIndex");
+    _state.index = _memory->get(_state.pc) << 8 | _memory->get(_state.pc + 1);
+    _state.pc += 2;
+    // ANNN, and fetching the address like another instruction
+    return 55 * 2;
+}
+
+// 0xFN01, XO-CHIP
+int CPU::opSelectPlanes(uint8_t x, Display* display)
+{
+    CHIP8_TRACE(Debug, Display, "opSelectPlanes %d", x);
+    display->selectPlanes(x);
+    return 45;
+}
+
 // 0xFX55
+template<bool INCREMENT_INDEX>
 int CPU::opStoreRegistersToMemory(uint8_t x)
 {
-    printf("opStoreRegistersToMemory\n");
+    CHIP8_TRACE(Debug, Memory, "opStoreRegistersToMemory");
     for (auto i=0; i <= x ; i++) {
-        _memory->set(_index + i, _registers->get(i));
+        _memory->set(_state.index + i, _registers->get(i));
+    }
+    if(INCREMENT_INDEX) {
+        _state.index += x + 1;
     }
     return 605 + x * 64;
 }
 
 // 0xFX65
+template<bool INCREMENT_INDEX>
 int CPU::opLoadRegistersFromMemory(uint8_t x)
 {
-    printf("opLoadRegistersFromMemory\n");
+    CHIP8_TRACE(Debug, Memory, "opLoadRegistersFromMemory");
     for(auto i=0; i <= x; i++) {
-        _registers->set(i, _memory->get(_index + i));
+        _registers->set(i, _memory->get(_state.index + i));
+    }
+    if(INCREMENT_INDEX) {
+        _state.index += x + 1;
     }
     return 605 + x * 64;
 }
@@ -266,58 +486,84 @@ int CPU::opLoadRegistersFromMemory(uint8_t x)
 // 0xFX33
 int CPU::opBinaryCodeDecimalConversion(uint8_t x)
 {
-    printf("opBinaryCodeDecimalConversion\n");
+    CHIP8_TRACE(Debug, Memory, "opBinaryCodeDecimalConversion");
     auto vx = _registers->get(x);
-    printf("%d\n", vx);
-    _memory->set(_index, vx / 100);
-    _memory->set(_index + 1, (vx / 10) % 10);
-    _memory->set(_index + 2, vx % 10);
-    printf("%d\n", _memory->get(_index));
-    printf("%d\n", _memory->get(_index+1));
-    printf("%d\n", _memory->get(_index+2));
-    // exit(0);
+    _memory->set(_state.index, vx / 100);
+    _memory->set(_state.index + 1, (vx / 10) % 10);
+    _memory->set(_state.index + 2, vx % 10);
     return 927;
 }
 
 // 0xFX1E
 int CPU::opAddToIndex(uint8_t x)
 {
-    printf("opAddToIndex\n");
-    _index += _registers->get(x);
+    CHIP8_TRACE(Debug, Decode, "opAddToIndex");
+    _state.index += _registers->get(x);
     return 86;
 }
 
 // 0xFX07
 int CPU::opGetDelayTimer(uint8_t x)
 {
-    printf("opGetDelayTimer\n");
-    _registers->set(x, _delayTimer);
+    CHIP8_TRACE(Debug, Decode, "opGetDelayTimer");
+    _registers->set(x, _state.delayTimer);
     return 45;
 }
 
 // 0xFX15
 int CPU::opSetDelayTimer(uint8_t x)
 {
-    printf("opSetDelayTimer\n");
-    _delayTimer = _registers->get(x);
+    CHIP8_TRACE(Debug, Decode, "opSetDelayTimer");
+    _state.delayTimer = _registers->get(x);
     return 45;
 }
 
 // 0xFX18
 int CPU::opSetSoundTimer(uint8_t x)
 {
-    printf("opSetSoundTimer\n");
-    _soundTimer = _registers->get(x);
+    CHIP8_TRACE(Debug, Decode, "opSetSoundTimer");
+    _state.soundTimer = _registers->get(x);
+    _soundWrittenAt = _state.microSeconds;
+    return 45;
+}
+
+// 0xF002, XO-CHIP
+int CPU::opLoadAudioPattern()
+{
+    CHIP8_TRACE(Debug, Memory, "opLoadAudioPattern");
+    for(uint8_t i = 0; i < PATTERN_SIZE; i++) {
+        _state.pattern[i] = _memory->get(_state.index + i);
+    }
+    _state.hasPattern = true;
+    _soundWrittenAt = _state.microSeconds;
+    // as long as loading 16 registers
+    return 605 + (PATTERN_SIZE - 1) * 64;
+}
+
+// 0xFX3A, XO-CHIP
+int CPU::opSetPitch(uint8_t x)
+{
+    CHIP8_TRACE(Debug, Decode, "opSetPitch");
+    _state.pitch = _registers->get(x);
+    _soundWrittenAt = _state.microSeconds;
     return 45;
 }
 
+// Skips the instruction at the PC, which is four bytes long if it is
+// XO-CHIP's F000 NNNN.
+void CPU::skipInstruction()
+{
+    auto longLoad = _memory->get(_state.pc) == 0xF0 && _memory->get(_state.pc + 1) == 0x00;
+    _state.pc += longLoad ? 4 : 2;
+}
+
 // 0x3XNN
 int CPU::opSkipIfVxEqualsNn(uint8_t x, uint8_t nn)
 {
-    printf("opSkipIfVxEquals\n");
+    CHIP8_TRACE(Debug, Decode, "opSkipIfVxEquals");
     auto clockCycles = 55;
     if(_registers->get(x) == nn) {
-        _pc += 2;
+        skipInstruction();
     } else {
         clockCycles += 9;
     }
@@ -327,10 +573,10 @@ int CPU::opSkipIfVxEqualsNn(uint8_t x, uint8_t nn)
 // 0x4XNN
 int CPU::opSkipIfVxNotEqualsNn(uint8_t x, uint8_t nn)
 {
-    printf("opSkipIfVxNotEquals\n");
+    CHIP8_TRACE(Debug, Decode, "opSkipIfVxNotEquals");
     auto clockCycles = 55;
     if(_registers->get(x) != nn) {
-        _pc += 2;
+        skipInstruction();
     } else {
         clockCycles += 9;
     }
@@ -340,10 +586,10 @@ int CPU::opSkipIfVxNotEqualsNn(uint8_t x, uint8_t nn)
 // 0x9XY0
 int CPU::opSkipIfVxNotEqualsVy(uint8_t x, uint8_t y)
 {
-    printf("opSkipIfVxNotEqualsVy\n");
+    CHIP8_TRACE(Debug, Decode, "opSkipIfVxNotEqualsVy");
     auto clockCycles = 73;
     if(_registers->get(x) != _registers->get(y)) {
-        _pc += 2;
+        skipInstruction();
     } else {
         clockCycles += 9;
     }
@@ -353,10 +599,10 @@ int CPU::opSkipIfVxNotEqualsVy(uint8_t x, uint8_t y)
 // 0x5XY0
 int CPU::opSkipIfVxEqualsVy(uint8_t x, uint8_t y)
 {
-    printf("opSkipIfVxEqualsVy\n");
+    CHIP8_TRACE(Debug, Decode, "opSkipIfVxEqualsVy");
     auto clockCycles = 55;
     if(_registers->get(x) == _registers->get(y)) {
-        _pc += 2;
+        skipInstruction();
     } else {
         clockCycles += 9;
     }
@@ -364,21 +610,21 @@ int CPU::opSkipIfVxEqualsVy(uint8_t x, uint8_t y)
 }
 
 // 0xEX9E
-int CPU::opSkipIfKeyPressed(uint8_t x, shared_ptr<Keyboard> keyboard)
+int CPU::opSkipIfKeyPressed(uint8_t x, Keyboard* keyboard)
 {
-    printf("opSkipIfKeyPressed\n");
+    CHIP8_TRACE(Debug, Input, "opSkipIfKeyPressed");
     if(keyboard->isKeyPressed(_registers->get(x))) {
-        _pc += 2;
+        skipInstruction();
     }
     return 73;
 }
 
 // 0xEXA1
-int CPU::opSkipIfNotKeyPressed(uint8_t x, shared_ptr<Keyboard> keyboard)
+int CPU::opSkipIfNotKeyPressed(uint8_t x, Keyboard* keyboard)
 {
-    printf("opSkipIfNotKeyPressed\n");
+    CHIP8_TRACE(Debug, Input, "opSkipIfNotKeyPressed");
     if(!keyboard->isKeyPressed(_registers->get(x))) {
-        _pc += 2;
+        skipInstruction();
     }
     return 73;
 }
@@ -386,32 +632,39 @@ int CPU::opSkipIfNotKeyPressed(uint8_t x, shared_ptr<Keyboard> keyboard)
 // 0xCXNN
 int CPU::opRandom(uint8_t x, uint8_t nn)
 {
-    printf("opRandom\n");
-    _registers->set(x, randByte(randGen) & nn);
+    CHIP8_TRACE(Debug, Decode, "opRandom");
+    auto random = _state.random;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    _state.random = random;
+    _registers->set(x, (random >> 24) & nn);
     return 73;
 }
 
-// 0xBNNN
-int CPU::opJumpWithOffset(uint16_t nnn)
+// 0xBNNN, or 0xBXNN with JUMP_USES_VX
+template<bool USE_VX>
+int CPU::opJumpWithOffset(uint8_t x, uint16_t nnn)
 {
-    printf("opJumpWithOffset\n");
-    _pc = nnn + _registers->get(0);
+    CHIP8_TRACE(Debug, Decode, "opJumpWithOffset");
+    _state.pc = nnn + _registers->get(USE_VX ? x : 0);
     return 105;
 }
 
 // 0x8XY0
 int CPU::opSetVxToValueOfVy(uint8_t x, uint8_t y)
 {
-    printf("opSetVxToValueOfVy\n");
+    CHIP8_TRACE(Debug, Decode, "opSetVxToValueOfVy");
     _registers->set(x, _registers->get(y));
     return 200;
 }
 
 // 0x8XY6
-int CPU::opShiftRight(uint8_t x)
+template<bool USE_VY>
+int CPU::opShiftRight(uint8_t x, uint8_t y)
 {
-    printf("opShiftRight\n");
-    auto vx = _registers->get(x);
+    CHIP8_TRACE(Debug, Decode, "opShiftRight");
+    auto vx = _registers->get(USE_VY ? y : x);
     auto flag = vx & 0x1;
     _registers->set(x, vx >> 1);
     _registers->set(0xF, flag);
@@ -419,10 +672,11 @@ int CPU::opShiftRight(uint8_t x)
 }
 
 // 0x8XYE
-int CPU::opShiftLeft(uint8_t x)
+template<bool USE_VY>
+int CPU::opShiftLeft(uint8_t x, uint8_t y)
 {
-    printf("opShiftLeft\n");
-    auto vx = _registers->get(x);
+    CHIP8_TRACE(Debug, Decode, "opShiftLeft");
+    auto vx = _registers->get(USE_VY ? y : x);
     auto flag = (vx & 0x80) >> 7;
     _registers->set(x, vx << 1);
     _registers->set(0xF, flag);
@@ -432,7 +686,7 @@ int CPU::opShiftLeft(uint8_t x)
 // 0x8XY5
 int CPU::opSubtractVyFromVx(uint8_t x, uint8_t y)
 {
-    printf("opSubtractVyFromVx\n");
+    CHIP8_TRACE(Debug, Decode, "opSubtractVyFromVx");
     uint8_t vx = _registers->get(x);
     uint8_t vy = _registers->get(y);
     auto borrow = vx > vy ? 1 : 0;
@@ -444,7 +698,7 @@ int CPU::opSubtractVyFromVx(uint8_t x, uint8_t y)
 // 0x8XY7
 int CPU::opSubtractVxFromVy(uint8_t x, uint8_t y)
 {
-    printf("opSubtractVxFromVy\n");
+    CHIP8_TRACE(Debug, Decode, "opSubtractVxFromVy");
     auto vx = _registers->get(x);
     auto vy = _registers->get(y);
     auto flag = vy > vx ? 1 : 0;
@@ -456,7 +710,7 @@ int CPU::opSubtractVxFromVy(uint8_t x, uint8_t y)
 // 0x8XY4
 int CPU::opAddWithCarry(uint8_t x, uint8_t y)
 {
-    printf("opAddWithCarry\n");
+    CHIP8_TRACE(Debug, Decode, "opAddWithCarry");
     auto sum = _registers->get(x) + _registers->get(y);
     _registers->set(0xF, sum > 255 ? 1 : 0);
     _registers->set(x, sum & 0xFF);
@@ -466,7 +720,7 @@ int CPU::opAddWithCarry(uint8_t x, uint8_t y)
 // 0x8XY1
 int CPU::opBinaryOr(uint8_t x, uint8_t y)
 {
-    printf("opBinaryOr\n");
+    CHIP8_TRACE(Debug, Decode, "opBinaryOr");
     auto vx = _registers->get(x);
     auto vy = _registers->get(y);
     _registers->set(x, vx | vy);
@@ -476,7 +730,7 @@ int CPU::opBinaryOr(uint8_t x, uint8_t y)
 // 0x8XY3
 int CPU::opBinaryXor(uint8_t x, uint8_t y)
 {
-    printf("opBinaryXor\n");
+    CHIP8_TRACE(Debug, Decode, "opBinaryXor");
     auto vx = _registers->get(x);
     auto vy = _registers->get(y);
     _registers->set(x, vx ^ vy);
@@ -486,7 +740,7 @@ int CPU::opBinaryXor(uint8_t x, uint8_t y)
 // 0x8XY2
 int CPU::opBinaryAnd(uint8_t x, uint8_t y)
 {
-    printf("opBinaryAnd\n");
+    CHIP8_TRACE(Debug, Decode, "opBinaryAnd");
     auto vx = _registers->get(x);
     auto vy = _registers->get(y);
     _registers->set(x, vx & vy);
@@ -496,11 +750,11 @@ int CPU::opBinaryAnd(uint8_t x, uint8_t y)
 // 0x2NNN
 int CPU::opJumpToSubroutine(uint16_t nnn)
 {
-    printf("opJumpToSubroutine\n");
-    if(_sp < 16) {
-        _stack[_sp] = _pc;
-        _sp++;
-        _pc = nnn;
+    CHIP8_TRACE(Debug, Decode, "opJumpToSubroutine");
+    if(_state.sp < 16) {
+        _state.stack[_state.sp] = _state.pc;
+        _state.sp++;
+        _state.pc = nnn;
     }
     return 105;
 }
@@ -0,0 +1,91 @@
+#include "chip8/decoder.h"
+
+using namespace Chip8;
+
+static std::array<Op, 16 * 256> buildTable()
+{
+    std::array<Op, 16 * 256> table;
+    for(int high = 0; high < 16; high++) {
+        for(int low = 0; low < 256; low++) {
+            table[high << 8 | low] = Decoder::decodeSwitch(high << 12 | low);
+        }
+    }
+    return table;
+}
+
+const std::array<Op, 16 * 256> Decoder::_table = buildTable();
+
+Op Decoder::decodeSwitch(uint16_t opcode)
+{
+    switch (opcode & 0xF000)
+    {
+        case 0x0000:
+            switch (opcode & 0x00FF)
+            {
+                case 0x00E0: return Op::ClearScreen;
+                case 0x000E: return Op::Return;
+                case 0x00EE: return Op::ReturnFromSubroutine;
+                // SUPER-CHIP
+                case 0x00FB: return Op::ScrollRight;
+                case 0x00FC: return Op::ScrollLeft;
+                case 0x00FE: return Op::LowResolution;
+                case 0x00FF: return Op::HighResolution;
+            }
+            if((opcode & 0x00F0) == 0x00C0) {
+                return Op::ScrollDown;
+            }
+            break;
+        case 0x1000: return Op::Jump;
+        case 0x2000: return Op::JumpToSubroutine;
+        case 0x3000: return Op::SkipIfVxEqualsNn;
+        case 0x4000: return Op::SkipIfVxNotEqualsNn;
+        case 0x5000: return Op::SkipIfVxEqualsVy;
+        case 0x6000: return Op::SetRegisterVxToNn;
+        case 0x7000: return Op::AddNnToRegisterVx;
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0000: return Op::SetVxToValueOfVy;
+                case 0x0001: return Op::BinaryOr;
+                case 0x0002: return Op::BinaryAnd;
+                case 0x0003: return Op::BinaryXor;
+                case 0x0004: return Op::AddWithCarry;
+                case 0x0005: return Op::SubtractVyFromVx;
+                case 0x0006: return Op::ShiftRight;
+                case 0x0007: return Op::SubtractVxFromVy;
+                case 0x000E: return Op::ShiftLeft;
+            }
+            break;
+        case 0x9000: return Op::SkipIfVxNotEqualsVy;
+        case 0xA000: return Op::SetIndexRegister;
+        case 0xB000: return Op::JumpWithOffset;
+        case 0xC000: return Op::Random;
+        case 0xD000: return Op::Display;
+        case 0xE000:
+            switch (opcode & 0x00FF) {
+                case 0x009E: return Op::SkipIfKeyPressed;
+                case 0x00A1: return Op::SkipIfNotKeyPressed;
+            }
+            break;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x0007: return Op::GetDelayTimer;
+                case 0x000A: return Op::GetKey;
+                case 0x0015: return Op::SetDelayTimer;
+                case 0x0018: return Op::SetSoundTimer;
+                case 0x001E: return Op::AddToIndex;
+                case 0x0029: return Op::FontCharacter;
+                case 0x0033: return Op::BinaryCodeDecimalConversion;
+                case 0x0055: return Op::StoreRegistersToMemory;
+                case 0x0065: return Op::LoadRegistersFromMemory;
+                // XO-CHIP, where F000 is followed by a 16 bit address
+                case 0x0000: return Op::LoadLongIndex;
+                case 0x0001: return Op::SelectPlanes;
+                case 0x0002: return Op::LoadAudioPattern;
+                case 0x003A: return Op::SetPitch;
+                // SUPER-CHIP
+                case 0x0030: return Op::LargeFontCharacter;
+            }
+            break;
+    }
+    return Op::Invalid;
+}
@@ -1,21 +1,148 @@
 #include "chip8/display.h"
+#include <cstring>
 
 using namespace Chip8;
 
-void Display::init()
-{    
-    //Create window
-    SDL_CreateWindowAndRenderer(640, 320, SDL_WINDOW_SHOWN, &_window, &_renderer);
-    if( _window == NULL || _renderer == NULL)
-    {
-        printf( "Window or renderer could not be created! SDL_Error: %s\n", SDL_GetError() );
+bool Display::drawSprite(uint8_t x, uint8_t y, const uint8_t* sprite, uint8_t height, SpriteEdge edge)
+{
+    uint64_t lines[15 * PLANES];
+    height = height < 15 ? height : 15;
+    for(int i = 0; i < height * getSelectedPlaneCount(); i++) {
+        lines[i] = static_cast<uint64_t>(sprite[i]) << 56;
+    }
+    return draw(x, y, lines, height, 8, edge);
+}
+
+bool Display::drawLargeSprite(uint8_t x, uint8_t y, const uint8_t* sprite, SpriteEdge edge)
+{
+    uint64_t lines[16 * PLANES];
+    for(int i = 0; i < 16 * getSelectedPlaneCount(); i++) {
+        lines[i] = static_cast<uint64_t>(sprite[i * 2]) << 56 | static_cast<uint64_t>(sprite[i * 2 + 1]) << 48;
+    }
+    return draw(x, y, lines, 16, 16, edge);
+}
+
+// Draws the next height lines onto each selected plane in turn.
+bool Display::draw(uint8_t x, uint8_t y, const uint64_t* lines, uint8_t height, uint8_t width, SpriteEdge edge)
+{
+    bool collision = false;
+    for(int plane = 0; plane < PLANES; plane++) {
+        if((_selectedPlanes >> plane) & 1) {
+            collision |= drawPlane(_planes[plane], x, y, lines, height, width, edge);
+            lines += height;
+        }
+    }
+    return collision;
+}
+
+// Each line holds one row of the sprite in its top width bits.
+bool Display::drawPlane(uint64_t* plane, uint8_t x, uint8_t y, const uint64_t* lines, uint8_t height, uint8_t width, SpriteEdge edge)
+{
+    int cols = getWidth();
+    int rows = getHeight();
+    x %= cols;
+    y %= rows;
+    bool wraps = edge == SpriteEdge::Wrap && x > cols - width;
+    uint64_t collision = 0;
+    for(uint8_t i = 0; i < height; i++) {
+        int row = y + i;
+        if(row >= rows) {
+            if(edge == SpriteEdge::Clip) {
+                break;
+            }
+            row -= rows;
+        }
+        auto bits = lines[i];
+        if(!_hires) {
+            auto line = bits >> x;
+            if(wraps) {
+                line |= bits << (COLS - x);
+            }
+            collision |= plane[row] & line;
+            plane[row] ^= line;
+            continue;
+        }
+        uint64_t left = x < 64 ? bits >> x : 0;
+        uint64_t right = x == 0 ? 0 : x < 64 ? bits << (64 - x) : bits >> (x - 64);
+        if(wraps) {
+            left |= bits << (HIRES_COLS - x);
+        }
+        auto words = &plane[row * 2];
+        collision |= (words[0] & left) | (words[1] & right);
+        words[0] ^= left;
+        words[1] ^= right;
+    }
+    return collision != 0;
+}
+
+static void scrollPlaneLeft(uint64_t* plane, bool hires, uint8_t pixels)
+{
+    if(!hires) {
+        for(int row = 0; row < ROWS; row++) {
+            plane[row] <<= pixels;
+        }
+        return;
+    }
+    for(int row = 0; row < HIRES_ROWS; row++) {
+        auto left = plane[row * 2];
+        auto right = plane[row * 2 + 1];
+        plane[row * 2] = left << pixels | right >> (64 - pixels);
+        plane[row * 2 + 1] = right << pixels;
+    }
+}
+
+static void scrollPlaneRight(uint64_t* plane, bool hires, uint8_t pixels)
+{
+    if(!hires) {
+        for(int row = 0; row < ROWS; row++) {
+            plane[row] >>= pixels;
+        }
+        return;
     }
+    for(int row = 0; row < HIRES_ROWS; row++) {
+        auto left = plane[row * 2];
+        auto right = plane[row * 2 + 1];
+        plane[row * 2] = left >> pixels;
+        plane[row * 2 + 1] = right >> pixels | left << (64 - pixels);
+    }
+}
 
+void Display::scrollDown(uint8_t pixels)
+{
+    int rows = getHeight();
+    int words = getRowWords();
+    int moved = pixels < rows ? rows - pixels : 0;
+    for(int plane = 0; plane < PLANES; plane++) {
+        if((_selectedPlanes >> plane) & 1) {
+            auto data = _planes[plane];
+            memmove(&data[(rows - moved) * words], data, moved * words * sizeof(uint64_t));
+            memset(data, 0, (rows - moved) * words * sizeof(uint64_t));
+        }
+    }
+}
+
+void Display::scrollLeft(uint8_t pixels)
+{
+    if(pixels == 0 || pixels >= 64) {
+        return;
+    }
+    for(int plane = 0; plane < PLANES; plane++) {
+        if((_selectedPlanes >> plane) & 1) {
+            scrollPlaneLeft(_planes[plane], _hires, pixels);
+        }
+    }
 }
 
-void Display::flipPixel(int index)
+void Display::scrollRight(uint8_t pixels)
 {
-    _frameBuffer[index] = !_frameBuffer[index];
+    if(pixels == 0 || pixels >= 64) {
+        return;
+    }
+    for(int plane = 0; plane < PLANES; plane++) {
+        if((_selectedPlanes >> plane) & 1) {
+            scrollPlaneRight(_planes[plane], _hires, pixels);
+        }
+    }
 }
 
 void Display::setDrawFlag(bool value)
@@ -28,28 +155,21 @@ bool Display::getDrawFlag()
     return _drawFlag;
 }
 
-void Display::clear()
+void Display::setPlanes(const uint64_t* planes)
 {
-    for(int i = 0; i < 64*32; i++){
-        _frameBuffer[i] = false;
-    }
+    memcpy(_planes, planes, sizeof(_planes));
 }
 
-void Display::draw()
+void Display::clear()
 {
-    SDL_SetRenderDrawColor(_renderer, 0x00, 0x00, 0x00, 0xFF);
-    SDL_RenderClear(_renderer);
-
-    SDL_SetRenderDrawColor(_renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-    for (int y = 0; y < 32; y++) {
-        for(int x = 0; x < 64; x++) {
-            if(_frameBuffer[y * 64 + x]) {
-                SDL_Rect rect = { x*10, y*10, 10, 10};
-                SDL_RenderFillRect(_renderer, &rect);
-            }
+    for(int plane = 0; plane < PLANES; plane++) {
+        if((_selectedPlanes >> plane) & 1) {
+            memset(_planes[plane], 0, sizeof(_planes[plane]));
         }
     }
-    
-    SDL_RenderPresent(_renderer);
-    _drawFlag = false;
+}
+
+void Display::clearAll()
+{
+    memset(_planes, 0, sizeof(_planes));
 }
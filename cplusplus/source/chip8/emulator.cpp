@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <cstring>
 #include "chip8/emulator.h"
 #include "chip8/cpu.h"
 #include "chip8/memory.h"
@@ -6,12 +7,17 @@
 #include "chip8/display.h"
 #include "chip8/keyboard.h"
 #include "chip8/audio.h"
+#include "chip8/snapshot.h"
+#include "chip8/rewind_buffer.h"
+#include "chip8/movie.h"
+#include "chip8/trace.h"
 #include <chrono>
+#include <thread>
 
 using namespace std;
 using namespace Chip8;
 
-Emulator::Emulator(shared_ptr<Memory> memory)
+Emulator::Emulator(shared_ptr<Memory> memory, int scale, Palette palette)
 {
     auto registers = make_shared<Registers>();
     _cpu = make_unique<CPU>(memory, registers);
@@ -19,6 +25,9 @@ Emulator::Emulator(shared_ptr<Memory> memory)
     _display = make_shared<Display>();
     _keyboard = make_shared<Keyboard>();
     _audio = make_shared<Audio>();
+    _renderer = make_unique<Renderer>(scale, palette);
+    _rewind = make_unique<RewindBuffer>(REWIND_BYTES);
+    setSeed(static_cast<uint32_t>(chrono::system_clock::now().time_since_epoch().count()));
 }
 
 Emulator::~Emulator()
@@ -26,9 +35,38 @@ Emulator::~Emulator()
     _display.reset();
     _keyboard.reset();
     _audio.reset();
+    _renderer.reset();
+    _rewind.reset();
     _cpu.reset();
 }
 
+void Emulator::setSpeed(double speed)
+{
+    _speed.store(speed > 0.0 ? speed : FramePacer::UNLIMITED, std::memory_order_relaxed);
+}
+
+void Emulator::setTiming(const Timing& timing)
+{
+    _cpu->setTiming(timing);
+}
+
+void Emulator::setQuirks(const Quirks& quirks)
+{
+    _cpu->setQuirks(quirks);
+}
+
+void Emulator::setSeed(uint32_t seed)
+{
+    _seed = seed;
+    _cpu->seedRandom(seed);
+}
+
+void Emulator::recordMovie(char const* filename)
+{
+    _movie = make_unique<Movie>(_seed, _cpu->getTiming(), _cpu->getQuirks());
+    _movieFilename = filename;
+}
+
 void Emulator::run()
 {
     if( SDL_Init( SDL_INIT_EVERYTHING ) < 0 )
@@ -36,38 +74,136 @@ void Emulator::run()
         printf( "SDL could not initialize! SDL_Error: %s\n", SDL_GetError() );
     }
     
-    _display->init();
+    _renderer->init();
+    // SDL_AUDIODRIVER=dummy or disk runs without a sound card
+    _audio->open();
+
+    _running.store(true, std::memory_order_release);
+    std::thread emulation(&Emulator::emulate, this);
 
     SDL_Event e; 
     bool quit = false; 
-    auto lastCycleTime = std::chrono::high_resolution_clock::now();
+    uint16_t keys = 0;
     while( quit == false ) {
-        printf("Updating keyboard!\n");
-        _keyboard->update();
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        
         while( SDL_PollEvent( &e ) ) {
-            // printf( "SDL event! %d\n", e.type);
             switch (e.type) {
                 case SDL_QUIT:
                     quit = true;
                     break;
-                case SDL_KEYDOWN:
+                case SDL_KEYDOWN: {
                     if (e.key.keysym.sym == SDLK_ESCAPE){
                         quit = true;
                     }
-                    _keyboard->handleKeyDown(e.key.keysym.sym);
+                    if (e.key.keysym.sym == SDLK_F5){
+                        _snapshotRequest.store(SAVE, std::memory_order_relaxed);
+                    }
+                    if (e.key.keysym.sym == SDLK_F7){
+                        _snapshotRequest.store(RESTORE, std::memory_order_relaxed);
+                    }
+                    if (e.key.keysym.sym == SDLK_BACKSPACE){
+                        _rewinding.store(true, std::memory_order_relaxed);
+                    }
+                    auto key = Keyboard::mapKey(e.key.keysym.sym);
+                    if(key >= 0) {
+                        keys |= 1 << key;
+                    }
                     break;
-                case SDL_KEYUP:
-                    _keyboard->handleKeyUp(e.key.keysym.sym);
+                }
+                case SDL_KEYUP: {
+                    if (e.key.keysym.sym == SDLK_BACKSPACE){
+                        _rewinding.store(false, std::memory_order_relaxed);
+                    }
+                    auto key = Keyboard::mapKey(e.key.keysym.sym);
+                    if(key >= 0) {
+                        keys &= ~(1 << key);
+                    }
                     break;
+                }
                 default:
                     break;
             }
         }
-        _cpu->tick(_display, _keyboard, _audio);
+        _keys.store(keys, std::memory_order_relaxed);
+
+        if(_frames.update()) {
+            auto& frame = _frames.front();
+            _renderer->present(frame.planes, frame.hires);
+        } else {
+            SDL_Delay(1);
+        }
+        // only the emulation thread writes trace records
+        CHIP8_TRACE_DRAIN(stdout);
+    }
+
+    _running.store(false, std::memory_order_release);
+    emulation.join();
+    _audio->close();
+    CHIP8_TRACE_DRAIN(stdout);
+
+    if(_movie && _movie->write(_movieFilename.c_str())) {
+        printf("Recorded %u frames to %s\n", _movie->getFrames(), _movieFilename.c_str());
+    }
+
+    printf("%llu frames, %llu dropped, jitter mean %.1f us max %.1f us, cpu %.1f%%\n",
+        static_cast<unsigned long long>(_pacerStats.frames),
+        static_cast<unsigned long long>(_pacerStats.dropped),
+        _pacerStats.meanJitter,
+        _pacerStats.maxJitter,
+        _pacerStats.cpuUsage * 100);
+}
+
+// Body of the emulation thread. The keypad snapshot is taken once per
+// frame, just like the single-threaded loop polled events once per frame.
+void Emulator::emulate()
+{
+    FramePacer pacer;
+    uint32_t frame = 0;
+    while(_running.load(std::memory_order_acquire)) {
+        auto speed = _speed.load(std::memory_order_relaxed);
+        if(speed != pacer.getSpeed()) {
+            pacer.setSpeed(speed);
+        }
+        auto frames = pacer.wait();
+        auto request = _snapshotRequest.exchange(NONE, std::memory_order_relaxed);
+        switch(_movie ? static_cast<uint8_t>(NONE) : request) {
+            case SAVE:
+                if(!_snapshot) {
+                    _snapshot = make_unique<Snapshot>();
+                }
+                _snapshot->save(*_cpu, *_display, *_keyboard);
+                break;
+            case RESTORE:
+                if(_snapshot) {
+                    _snapshot->restore(*_cpu, *_display, *_keyboard);
+                }
+                break;
+            default:
+                break;
+        }
+        for(uint32_t i = 0; i < frames; i++) {
+            if(!_movie && _rewinding.load(std::memory_order_relaxed)) {
+                _rewind->rewind(*_cpu, *_display, *_keyboard);
+                if(_audio->isPlaying()) {
+                    _audio->pause();
+                }
+                continue;
+            }
+            CHIP8_TRACE(Debug, Input, "Updating keyboard!");
+            _keyboard->update();
+            _keyboard->setState(_keys.load(std::memory_order_relaxed));
+            if(_movie) {
+                _movie->record(frame++, _keyboard->getState());
+            }
+            _cpu->tick(_display, _keyboard, _audio);
+            _rewind->record(*_cpu, *_display, *_keyboard);
+        }
         if(_display->getDrawFlag()){
-            _display->draw();
+            auto& frame = _frames.back();
+            memcpy(frame.planes, _display->getPlanes(), sizeof(frame.planes));
+            frame.hires = _display->isHires();
+            _frames.publish();
+            _display->setDrawFlag(false);
         }
     }
+    _pacerStats = pacer.getStats();
 }
@@ -0,0 +1,200 @@
+#include "chip8/emulator_pool.h"
+#include "chip8/cpu.h"
+#include "chip8/memory.h"
+#include "chip8/registers.h"
+#include "chip8/display.h"
+#include "chip8/keyboard.h"
+#include "chip8/audio.h"
+
+using namespace std;
+using namespace Chip8;
+
+static uint64_t packRange(uint64_t begin, uint64_t end) {
+    return (end << 32) | begin;
+}
+
+EmulatorPool::EmulatorPool(size_t machines, unsigned int threads)
+    : _generation(0)
+    , _running(0)
+    , _stop(false)
+    , _frames(0)
+{
+    _machines.reserve(machines);
+    for(size_t i = 0; i < machines; i++) {
+        auto machine = make_unique<Machine>();
+        machine->memory = make_shared<Memory>();
+        machine->registers = make_shared<Registers>();
+        machine->cpu = make_shared<CPU>(machine->memory, machine->registers);
+        machine->display = make_shared<Display>();
+        machine->keyboard = make_shared<Keyboard>();
+        machine->audio = make_shared<Audio>();
+        _machines.push_back(move(machine));
+    }
+
+    if(threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    _ranges = make_unique<WorkRange[]>(threads);
+    for(unsigned int i = 0; i < threads; i++) {
+        _ranges[i].range.store(0, memory_order_relaxed);
+    }
+    for(unsigned int i = 1; i < threads; i++) {
+        _workers.emplace_back(&EmulatorPool::workerLoop, this, i);
+    }
+}
+
+EmulatorPool::~EmulatorPool()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        _stop = true;
+    }
+    _start.notify_all();
+    for(auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+RomError EmulatorPool::loadROM(char const* filename)
+{
+    Rom rom;
+    auto error = rom.open(filename);
+    return error != RomError::None ? error : loadROM(rom.data(), rom.size());
+}
+
+RomError EmulatorPool::loadROM(const uint8_t* data, size_t length)
+{
+    for(size_t i = 0; i < _machines.size(); i++) {
+        auto error = loadROM(i, data, length);
+        if(error != RomError::None) {
+            return error;
+        }
+    }
+    return RomError::None;
+}
+
+RomError EmulatorPool::loadROM(size_t machine, char const* filename)
+{
+    Rom rom;
+    auto error = rom.open(filename);
+    return error != RomError::None ? error : loadROM(machine, rom.data(), rom.size());
+}
+
+RomError EmulatorPool::loadROM(size_t machine, const uint8_t* data, size_t length)
+{
+    return _machines[machine]->memory->loadROM(data, length);
+}
+
+uint64_t EmulatorPool::getInstructionCount() const
+{
+    uint64_t count = 0;
+    for(auto& machine : _machines) {
+        count += machine->cpu->getInstructionCount();
+    }
+    return count;
+}
+
+void EmulatorPool::runFrames(uint64_t frames)
+{
+    auto threads = getThreadCount();
+    auto count = _machines.size();
+    for(unsigned int i = 0; i < threads; i++) {
+        _ranges[i].range.store(packRange(count * i / threads, count * (i + 1) / threads), memory_order_relaxed);
+    }
+
+    {
+        lock_guard<mutex> lock(_mutex);
+        _frames = frames;
+        _running = threads - 1;
+        _generation++;
+    }
+    _start.notify_all();
+
+    runBatch(0);
+
+    unique_lock<mutex> lock(_mutex);
+    _done.wait(lock, [this] { return _running == 0; });
+}
+
+void EmulatorPool::workerLoop(unsigned int worker)
+{
+    uint64_t generation = 0;
+    while(true) {
+        {
+            unique_lock<mutex> lock(_mutex);
+            _start.wait(lock, [&] { return _stop || _generation != generation; });
+            if(_stop) {
+                return;
+            }
+            generation = _generation;
+        }
+
+        runBatch(worker);
+
+        {
+            lock_guard<mutex> lock(_mutex);
+            _running--;
+        }
+        _done.notify_one();
+    }
+}
+
+void EmulatorPool::runBatch(unsigned int worker)
+{
+    size_t machine;
+    do {
+        while(popWork(worker, machine)) {
+            runMachine(*_machines[machine]);
+        }
+    } while(stealWork(worker));
+}
+
+// Takes the next machine from the front of the worker's own range.
+bool EmulatorPool::popWork(unsigned int worker, size_t& machine)
+{
+    auto& range = _ranges[worker].range;
+    auto current = range.load(memory_order_acquire);
+    while(true) {
+        auto begin = current & 0xFFFFFFFF;
+        auto end = current >> 32;
+        if(begin >= end) {
+            return false;
+        }
+        if(range.compare_exchange_weak(current, packRange(begin + 1, end), memory_order_acq_rel)) {
+            machine = begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of another worker's remaining range into this
+// worker's own range. Fails once every range is empty.
+bool EmulatorPool::stealWork(unsigned int worker)
+{
+    auto threads = getThreadCount();
+    for(unsigned int i = 1; i < threads; i++) {
+        auto& range = _ranges[(worker + i) % threads].range;
+        auto current = range.load(memory_order_acquire);
+        while(true) {
+            auto begin = current & 0xFFFFFFFF;
+            auto end = current >> 32;
+            if(begin >= end) {
+                break;
+            }
+            auto split = end - (end - begin + 1) / 2;
+            if(range.compare_exchange_weak(current, packRange(begin, split), memory_order_acq_rel)) {
+                _ranges[worker].range.store(packRange(split, end), memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void EmulatorPool::runMachine(Machine& machine)
+{
+    for(uint64_t frame = 0; frame < _frames; frame++) {
+        machine.keyboard->update();
+        machine.cpu->tick(machine.display, machine.keyboard, machine.audio);
+    }
+}
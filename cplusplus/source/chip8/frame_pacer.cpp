@@ -0,0 +1,145 @@
+#include "chip8/frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+using namespace Chip8;
+
+static const int64_t NANOSECONDS = 1000000000;
+
+// Both clocks in nanoseconds.
+#if defined(__linux__)
+static int64_t now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * NANOSECONDS + time.tv_nsec;
+}
+
+static int64_t cpuTime()
+{
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec * NANOSECONDS + time.tv_nsec;
+}
+
+static void sleepUntil(int64_t deadline)
+{
+    timespec time;
+    time.tv_sec = deadline / NANOSECONDS;
+    time.tv_nsec = deadline % NANOSECONDS;
+    // restarts with the same absolute deadline when a signal interrupts it
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR) {
+    }
+}
+#else
+static int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t cpuTime()
+{
+    return static_cast<int64_t>(std::clock()) * (NANOSECONDS / CLOCKS_PER_SEC);
+}
+
+static void sleepUntil(int64_t deadline)
+{
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline)));
+}
+#endif
+
+FramePacer::FramePacer(uint32_t rate)
+    : _rate(rate)
+    , _speed(1.0)
+    , _started(false)
+    , _start(0)
+    , _epoch(0)
+    , _epochFrame(0)
+    , _startCpu(0)
+    , _next(0)
+    , _frames(0)
+    , _dropped(0)
+    , _sleeps(0)
+    , _totalJitter(0)
+    , _maxJitter(0)
+{
+}
+
+int64_t FramePacer::deadline(uint64_t frame) const
+{
+    auto frames = frame - _epochFrame;
+    if(_speed == 1.0) {
+        return _epoch + static_cast<int64_t>(frames / _rate) * NANOSECONDS
+            + static_cast<int64_t>(frames % _rate) * NANOSECONDS / _rate;
+    }
+    return _epoch + llround(frames * (NANOSECONDS / (_rate * _speed)));
+}
+
+void FramePacer::setSpeed(double speed)
+{
+    _speed = speed > 0.0 ? speed : UNLIMITED;
+    if(_started) {
+        // the new schedule starts from the frame that ran last
+        _epoch = now();
+        _epochFrame = _next - 1;
+    }
+}
+
+uint32_t FramePacer::wait()
+{
+    if(!_started) {
+        _started = true;
+        _start = now();
+        _startCpu = cpuTime();
+        _epoch = _start;
+        _epochFrame = 0;
+        _next = 1;
+        _frames = 1;
+        return 1;
+    }
+    if(_speed == UNLIMITED) {
+        _next++;
+        _frames++;
+        return 1;
+    }
+
+    auto due = deadline(_next);
+    auto time = now();
+    uint32_t frames = 1;
+    if(time < due) {
+        sleepUntil(due);
+        auto jitter = now() - due;
+        _sleeps++;
+        _totalJitter += jitter;
+        _maxJitter = std::max(_maxJitter, jitter);
+    } else {
+        // every deadline up to now has passed
+        uint64_t behind = 1;
+        while(deadline(_next + behind) <= time) {
+            behind++;
+        }
+        frames = static_cast<uint32_t>(std::min<uint64_t>(behind, MAX_CATCH_UP));
+        _dropped += behind - frames;
+        _next += behind - frames;
+    }
+    _next += frames;
+    _frames += frames;
+    return frames;
+}
+
+PacerStats FramePacer::getStats() const
+{
+    PacerStats stats;
+    stats.frames = _frames;
+    stats.dropped = _dropped;
+    stats.meanJitter = _sleeps > 0 ? _totalJitter / 1000.0 / _sleeps : 0.0;
+    stats.maxJitter = _maxJitter / 1000.0;
+    auto wall = now() - _start;
+    stats.cpuUsage = _started && wall > 0 ? static_cast<double>(cpuTime() - _startCpu) / wall : 0.0;
+    return stats;
+}
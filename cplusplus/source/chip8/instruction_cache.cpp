@@ -0,0 +1,26 @@
+#include "chip8/instruction_cache.h"
+
+using namespace Chip8;
+
+InstructionCache::InstructionCache()
+{
+    invalidate();
+}
+
+void InstructionCache::invalidate()
+{
+    for (auto& slot : _slots) {
+        slot.valid = false;
+    }
+}
+
+void InstructionCache::onMemoryWritten(uint16_t addr, uint16_t length)
+{
+    uint32_t end = addr + length;
+    if(end > RAM_SIZE) {
+        end = RAM_SIZE;
+    }
+    for (uint32_t slot = addr >> 1; slot < (end + 1) >> 1; slot++) {
+        _slots[slot].valid = false;
+    }
+}
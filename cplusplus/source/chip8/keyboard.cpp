@@ -1,13 +1,12 @@
 #include "chip8/keyboard.h"
+#include "chip8/trace.h"
 
 using namespace Chip8;
     
 Keyboard::Keyboard()
+    : _keypad(0)
+    , _lastState(0)
 {
-    for (int i = 0; i < 16; i++)
-    {
-        _keypad[i] = false;
-    }   
 }
 
 Keyboard::~Keyboard()
@@ -17,70 +16,63 @@ Keyboard::~Keyboard()
 
 void Keyboard::update()
 {
-    for (int i = 0; i < 16; i++)
-    {
-        _lastState[i] = _keypad[i];
-    }   
+    _lastState = _keypad;
 }
 
 bool Keyboard::hasBeenReleased(uint8_t key)
 {
-    return _lastState[key] && _keypad[key]== false;
+    return (_lastState & ~_keypad) >> (key & 0xF) & 1;
 }
 
 bool Keyboard::isKeyPressed(uint8_t key)
 {
-    return _keypad[key];
+    return _keypad >> (key & 0xF) & 1;
 }
 
 void Keyboard::handleKeyDown(SDL_Keycode key) {
-    printf("KeyDown: %d\n", key);
-    switch(key) {
-        case SDLK_1: _keypad[0x1] = true; break;
-        case SDLK_2: _keypad[0x2] = true; break;
-        case SDLK_3: _keypad[0x3] = true; break;
-        case SDLK_4: _keypad[0xC] = true; break;
-
-        case SDLK_q: _keypad[0x4] = true; break;
-        case SDLK_w: _keypad[0x5] = true; break;
-        case SDLK_e: _keypad[0x6] = true; break;
-        case SDLK_r: _keypad[0xD] = true; break;
-
-        case SDLK_a: _keypad[0x7] = true; break;
-        case SDLK_s: _keypad[0x8] = true; break;
-        case SDLK_d: _keypad[0x9] = true; break;
-        case SDLK_f: _keypad[0xE] = true; break;
-
-        case SDLK_z: _keypad[0xA] = true; break;
-        case SDLK_x: _keypad[0x0] = true; break;
-        case SDLK_c: _keypad[0xB] = true; break;
-        case SDLK_v: _keypad[0xF] = true; break;
-        default: break;
+    CHIP8_TRACE(Debug, Input, "KeyDown: %d", key);
+    auto index = mapKey(key);
+    if(index >= 0) {
+        setKey(index, true);
     }
 }
 
-
 void Keyboard::handleKeyUp(SDL_Keycode key) {
+    auto index = mapKey(key);
+    if(index >= 0) {
+        setKey(index, false);
+    }
+}
+
+int Keyboard::mapKey(SDL_Keycode key) {
     switch(key) {
-        case SDLK_1: _keypad[0x1] = false; break;
-        case SDLK_2: _keypad[0x2] = false; break;
-        case SDLK_3: _keypad[0x3] = false; break;
-        case SDLK_4: _keypad[0xC] = false; break;
+        case SDLK_1: return 0x1;
+        case SDLK_2: return 0x2;
+        case SDLK_3: return 0x3;
+        case SDLK_4: return 0xC;
 
-        case SDLK_q: _keypad[0x4] = false; break;
-        case SDLK_w: _keypad[0x5] = false; break;
-        case SDLK_e: _keypad[0x6] = false; break;
-        case SDLK_r: _keypad[0xD] = false; break;
+        case SDLK_q: return 0x4;
+        case SDLK_w: return 0x5;
+        case SDLK_e: return 0x6;
+        case SDLK_r: return 0xD;
 
-        case SDLK_a: _keypad[0x7] = false; break;
-        case SDLK_s: _keypad[0x8] = false; break;
-        case SDLK_d: _keypad[0x9] = false; break;
-        case SDLK_f: _keypad[0xE] = false; break;
+        case SDLK_a: return 0x7;
+        case SDLK_s: return 0x8;
+        case SDLK_d: return 0x9;
+        case SDLK_f: return 0xE;
 
-        case SDLK_z: _keypad[0xA] = false; break;
-        case SDLK_x: _keypad[0x0] = false; break;
-        case SDLK_c: _keypad[0xB] = false; break;
-        case SDLK_v: _keypad[0xF] = false; break;
-        default: break;
+        case SDLK_z: return 0xA;
+        case SDLK_x: return 0x0;
+        case SDLK_c: return 0xB;
+        case SDLK_v: return 0xF;
+        default: return -1;
     }
 }
+
+uint16_t Keyboard::getState() const {
+    return _keypad;
+}
+
+void Keyboard::setState(uint16_t keys) {
+    _keypad = keys;
+}
@@ -1,6 +1,7 @@
 #include "chip8/memory.h"
-#include <fstream>
-#include <sstream>
+#include "chip8/trace.h"
+#include <algorithm>
+#include <cstring>
 
 using namespace Chip8;
 
@@ -24,47 +25,99 @@ uint8_t SPRITE_CHARS[80] =
     0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
+uint8_t LARGE_SPRITE_CHARS[160] =
+{
+    0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, // 0
+    0x18, 0x38, 0x58, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3C, // 1
+    0x3E, 0x7F, 0xC3, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xFF, 0xFF, // 2
+    0x3C, 0x7E, 0xC3, 0x03, 0x0E, 0x0E, 0x03, 0xC3, 0x7E, 0x3C, // 3
+    0x06, 0x0E, 0x1E, 0x36, 0x66, 0xC6, 0xFF, 0xFF, 0x06, 0x06, // 4
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFE, 0x03, 0xC3, 0x7E, 0x3C, // 5
+    0x3E, 0x7C, 0xC0, 0xC0, 0xFC, 0xFE, 0xC3, 0xC3, 0x7E, 0x3C, // 6
+    0xFF, 0xFF, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x60, 0x60, // 7
+    0x3C, 0x7E, 0xC3, 0xC3, 0x7E, 0x7E, 0xC3, 0xC3, 0x7E, 0x3C, // 8
+    0x3C, 0x7E, 0xC3, 0xC3, 0x7F, 0x3F, 0x03, 0x03, 0x3E, 0x7C, // 9
+    0x18, 0x3C, 0x66, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+    0xFC, 0xFE, 0xC3, 0xC3, 0xFE, 0xFE, 0xC3, 0xC3, 0xFE, 0xFC, // B
+    0x3C, 0x7E, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0x7E, 0x3C, // C
+    0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFC, 0xC0, 0xC0, 0xFF, 0xFF, // E
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFC, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
+
+Memory::Memory()
+    : _ram(RAM_SIZE, 0)
+{
+    load(SPRITE_CHARS_ADDR, SPRITE_CHARS, 80);
+    load(LARGE_SPRITE_CHARS_ADDR, LARGE_SPRITE_CHARS, 160);
+}
+
+void Memory::addObserver(MemoryObserver* observer) {
+    _observers.push_back(observer);
+}
+
+void Memory::removeObserver(MemoryObserver* observer) {
+    _observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+}
 
-Memory::Memory() {
-    for (int i = 0; i < 4096; i++) {
-        _ram[i] = 0x00;
+void Memory::notifyWritten(uint16_t addr, uint16_t length) {
+    for (auto observer : _observers) {
+        observer->onMemoryWritten(addr, length);
     }
-    load(0x0000, SPRITE_CHARS, 80);
+}
+
+void Memory::setSize(uint32_t size) {
+    if (size == getSize()) {
+        return;
+    }
+    _ram.resize(size, 0);
+    _ram.shrink_to_fit();
+    _mask = static_cast<uint16_t>(size - 1);
 }
 
 void Memory::set(uint16_t addr, uint8_t value) {
+    addr &= _mask;
     _ram[addr] = value;
+    notifyWritten(addr, 1);
 }
 
-uint8_t Memory::get(uint16_t addr) {
-    return _ram[addr];
+bool Memory::restore(uint16_t addr, const uint8_t* data, uint32_t length) {
+    if (addr + length > getSize()) {
+        return false;
+    }
+    const uint32_t LINE = 64;
+    for (uint32_t offset = 0; offset < length; offset += LINE) {
+        auto size = static_cast<uint16_t>(std::min<uint32_t>(LINE, length - offset));
+        if (memcmp(_ram.data() + addr + offset, data + offset, size) != 0) {
+            memcpy(_ram.data() + addr + offset, data + offset, size);
+            notifyWritten(addr + offset, size);
+        }
+    }
+    return true;
 }
 
 void Memory::load(int addr, uint8_t* data, int length) {
     for (int i = 0; i < length; i++) {
         _ram[addr + i] = data[i];
     }
+    notifyWritten(addr, length);
 }
 
-void Memory::loadROM(char const* filename)
+RomError Memory::loadROM(char const* filename)
 {
-	std::ifstream file(filename, std::ios::binary | std::ios::ate);
-	if (file.is_open())
-	{
-		std::streampos size = file.tellg();
-		char* buffer = new char[size];
-
-		file.seekg(0, std::ios::beg);
-		file.read(buffer, size);
-		file.close();
+    Rom rom;
+    auto error = rom.open(filename);
+    return error != RomError::None ? error : loadROM(rom.data(), rom.size());
+}
 
-		for (long i = 0; i < size; ++i)
-		{
-			_ram[PROGRAM_START_ADDRESS + i] = buffer[i];
-            // printf("%02x\n", static_cast<uint8_t>(buffer[i]));
-		}
-        // _ram[0x1ff] = 4;
-        printf("ROM Loaded...\n");
-		delete[] buffer;
-	}
-}
\ No newline at end of file
+RomError Memory::loadROM(const uint8_t* data, size_t length)
+{
+    if (length > getSize() - PROGRAM_START_ADDRESS) {
+        return RomError::TooLarge;
+    }
+    memcpy(_ram.data() + PROGRAM_START_ADDRESS, data, length);
+    notifyWritten(PROGRAM_START_ADDRESS, static_cast<uint16_t>(length));
+    CHIP8_TRACE(Info, Memory, "ROM Loaded...");
+    return RomError::None;
+}
@@ -0,0 +1,119 @@
+#include "chip8/movie.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace Chip8;
+
+static const uint8_t MAGIC[4] = { 'C', '8', 'M', 'V' };
+
+static void put(std::vector<uint8_t>& out, uint32_t value, int bytes)
+{
+    for(int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+static uint32_t get(const uint8_t* in, int bytes)
+{
+    uint32_t value = 0;
+    for(int i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(in[i]) << (i * 8);
+    }
+    return value;
+}
+
+Movie::Movie(uint32_t seed, const Timing& timing, const Quirks& quirks)
+    : _seed(seed)
+    , _timing(timing)
+    , _quirks(quirks)
+    , _frames(0)
+{
+}
+
+void Movie::record(uint32_t frame, uint16_t keys)
+{
+    if(getKeys(frame) != keys) {
+        _inputs.push_back({ frame, keys });
+    }
+    _frames = std::max(_frames, frame + 1);
+}
+
+uint16_t Movie::getKeys(uint32_t frame) const
+{
+    // the last change at or before the frame
+    auto next = std::upper_bound(_inputs.begin(), _inputs.end(), frame,
+        [](uint32_t frame, const Input& input) { return frame < input.frame; });
+    return next == _inputs.begin() ? 0 : (next - 1)->keys;
+}
+
+bool Movie::write(char const* filename) const
+{
+    std::vector<uint8_t> out(MAGIC, MAGIC + sizeof(MAGIC));
+    put(out, VERSION, 4);
+    put(out, _seed, 4);
+    put(out, static_cast<uint32_t>(_timing.frameBudget), 4);
+    put(out, static_cast<uint32_t>(_timing.instructionCost), 4);
+    put(out, _quirks.getMask(), 4);
+    put(out, _quirks.memorySize, 4);
+    put(out, _frames, 4);
+    put(out, static_cast<uint32_t>(_inputs.size()), 4);
+    for(auto& input : _inputs) {
+        put(out, input.frame, 4);
+        put(out, input.keys, 2);
+    }
+
+    auto file = fopen(filename, "wb");
+    if(file == nullptr) {
+        printf("Could not open %s for writing\n", filename);
+        return false;
+    }
+    auto written = fwrite(out.data(), out.size(), 1, file);
+    fclose(file);
+    return written == 1;
+}
+
+bool Movie::read(char const* filename)
+{
+    auto file = fopen(filename, "rb");
+    if(file == nullptr) {
+        printf("Could not open %s\n", filename);
+        return false;
+    }
+    std::vector<uint8_t> in;
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        in.insert(in.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    const size_t HEADER = 36;
+    const size_t INPUT = 6;
+    if(in.size() < HEADER || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), in.begin()) || get(&in[4], 4) != VERSION) {
+        printf("%s is not a movie of version %u\n", filename, VERSION);
+        return false;
+    }
+    auto count = get(&in[32], 4);
+    if(in.size() != HEADER + count * INPUT) {
+        printf("%s is truncated\n", filename);
+        return false;
+    }
+
+    auto memorySize = get(&in[24], 4);
+    if(memorySize != RAM_SIZE && memorySize != XO_RAM_SIZE) {
+        printf("%s has %u bytes of memory\n", filename, memorySize);
+        return false;
+    }
+
+    _seed = get(&in[8], 4);
+    _timing = { static_cast<int32_t>(get(&in[12], 4)), static_cast<int32_t>(get(&in[16], 4)) };
+    _quirks = Quirks::fromMask(static_cast<uint8_t>(get(&in[20], 4)));
+    _quirks.memorySize = memorySize;
+    _frames = get(&in[28], 4);
+    _inputs.clear();
+    for(uint32_t i = 0; i < count; i++) {
+        auto input = &in[HEADER + i * INPUT];
+        _inputs.push_back({ get(input, 4), static_cast<uint16_t>(get(input + 4, 2)) });
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#include "chip8/quirks.h"
+#include <cstring>
+
+using namespace Chip8;
+
+uint8_t Quirks::getMask() const
+{
+    return (shiftUsesVy ? SHIFT_USES_VY : 0)
+        | (loadStoreIncrementsIndex ? LOAD_STORE_INCREMENTS_INDEX : 0)
+        | (jumpUsesVx ? JUMP_USES_VX : 0)
+        | (spriteEdge == SpriteEdge::Wrap ? SPRITES_WRAP : 0);
+}
+
+Quirks Quirks::fromMask(uint8_t mask)
+{
+    Quirks quirks;
+    quirks.shiftUsesVy = mask & SHIFT_USES_VY;
+    quirks.loadStoreIncrementsIndex = mask & LOAD_STORE_INCREMENTS_INDEX;
+    quirks.jumpUsesVx = mask & JUMP_USES_VX;
+    quirks.spriteEdge = mask & SPRITES_WRAP ? SpriteEdge::Wrap : SpriteEdge::Clip;
+    return quirks;
+}
+
+Quirks Quirks::chip8()
+{
+    return fromMask(SHIFT_USES_VY | LOAD_STORE_INCREMENTS_INDEX);
+}
+
+Quirks Quirks::superChip()
+{
+    return fromMask(JUMP_USES_VX);
+}
+
+Quirks Quirks::xoChip()
+{
+    auto quirks = fromMask(SHIFT_USES_VY | LOAD_STORE_INCREMENTS_INDEX | SPRITES_WRAP);
+    quirks.memorySize = XO_RAM_SIZE;
+    return quirks;
+}
+
+bool Quirks::parse(char const* name, Quirks& quirks)
+{
+    if(strcmp(name, "default") == 0) {
+        quirks = Quirks();
+    } else if(strcmp(name, "chip8") == 0) {
+        quirks = chip8();
+    } else if(strcmp(name, "schip") == 0) {
+        quirks = superChip();
+    } else if(strcmp(name, "xochip") == 0) {
+        quirks = xoChip();
+    } else {
+        return false;
+    }
+    return true;
+}
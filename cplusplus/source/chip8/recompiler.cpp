@@ -0,0 +1,415 @@
+#if defined(CHIP8_JIT_ENABLED)
+#include "chip8/recompiler.h"
+#include "chip8/decoder.h"
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace Chip8;
+
+// Offsets of the JitState fields, all reachable with an 8 bit displacement.
+static const uint8_t INDEX = offsetof(JitState, index);
+static const uint8_t PC = offsetof(JitState, pc);
+static const uint8_t MICRO_SECONDS = offsetof(JitState, microSeconds);
+static const uint8_t INSTRUCTION_COUNT = offsetof(JitState, instructionCount);
+static const uint8_t DELAY_TIMER = offsetof(JitState, delayTimer);
+
+static const uint8_t JE = 0x84;
+static const uint8_t JNE = 0x85;
+static const uint8_t JG = 0x8F;
+
+// Emits x86-64 code for one region. The state pointer stays in rdi and the
+// V registers are addressed through rsi, eax, ecx and edx are scratch.
+class Emitter {
+    public:
+        std::vector<uint8_t> code;
+
+        Emitter(uint16_t start, int32_t instructionCost)
+            : _start(start)
+            , _instructionCost(instructionCost)
+        {
+            bytes({ 0x48, 0x8B, 0x37 });                    // mov rsi, [rdi]
+            _body = code.size();
+        }
+
+        void bytes(std::initializer_list<uint8_t> values) {
+            code.insert(code.end(), values);
+        }
+
+        void word(uint16_t value) {
+            bytes({ static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) });
+        }
+
+        void dword(uint32_t value) {
+            word(value);
+            word(value >> 16);
+        }
+
+        // jcc rel32 with the target patched in by bind
+        size_t jumpForward(uint8_t condition) {
+            bytes({ 0x0F, condition });
+            dword(0);
+            return code.size();
+        }
+
+        void bind(size_t jump) {
+            uint32_t offset = code.size() - jump;
+            memcpy(&code[jump - 4], &offset, 4);
+        }
+
+        // add qword [rdi+INSTRUCTION_COUNT], 1
+        void countInstruction() { bytes({ 0x48, 0x83, 0x47, INSTRUCTION_COUNT, 0x01 }); }
+
+        // sub dword [rdi+MICRO_SECONDS], cycles
+        // A fixed instruction cost replaces the cycles of the VIP.
+        void charge(int cycles) {
+            bytes({ 0x81, 0x6F, MICRO_SECONDS });
+            dword(_instructionCost != 0 ? _instructionCost : cycles);
+        }
+
+        // mov word [rdi+PC], pc; ret
+        void exit(uint16_t pc) {
+            bytes({ 0x66, 0xC7, 0x47, PC });
+            word(pc);
+            bytes({ 0xC3 });
+        }
+
+        // Continues at pc after a charge. Jumping back to the start of the
+        // region loops natively while there is budget left.
+        void leave(uint16_t pc) {
+            if(pc == _start) {
+                bytes({ 0x0F, JG });                        // jg body
+                dword(static_cast<uint32_t>(_body - (code.size() + 4)));
+            }
+            exit(pc);
+        }
+
+        // Leaves with pc when the budget is spent and falls through otherwise.
+        void continueWithBudget(uint16_t pc) {
+            auto jump = jumpForward(JG);
+            exit(pc);
+            bind(jump);
+        }
+
+        // movzx eax, byte [rsi+x] / movzx ecx, byte [rsi+y]
+        void loadVxToEax(uint8_t x) { bytes({ 0x0F, 0xB6, 0x46, x }); }
+        void loadVyToEcx(uint8_t y) { bytes({ 0x0F, 0xB6, 0x4E, y }); }
+
+        // mov byte [rsi+x], al / cl / dl
+        void storeAl(uint8_t x) { bytes({ 0x88, 0x46, x }); }
+        void storeCl(uint8_t x) { bytes({ 0x88, 0x4E, x }); }
+        void storeDl(uint8_t x) { bytes({ 0x88, 0x56, x }); }
+
+        // seta dl
+        void setAboveToDl() { bytes({ 0x0F, 0x97, 0xC2 }); }
+
+        // Both paths of a skip end the region. notSkip is the condition
+        // under which the instruction does not skip.
+        void skip(uint8_t notSkip, uint16_t pc, int cycles) {
+            auto jump = jumpForward(notSkip);
+            charge(cycles);
+            leave(pc + 4);
+            bind(jump);
+            charge(cycles + 9);
+            leave(pc + 2);
+        }
+
+    private:
+        uint16_t _start;
+        int32_t _instructionCost;
+        size_t _body;
+};
+
+static bool isSkip(Op op)
+{
+    return op == Op::SkipIfVxEqualsNn || op == Op::SkipIfVxNotEqualsNn
+        || op == Op::SkipIfVxEqualsVy || op == Op::SkipIfVxNotEqualsVy;
+}
+
+// Emits one instruction at pc and returns false if it can not be compiled.
+// Sets ends when the instruction leaves the region.
+static bool emit(Emitter& e, const Instruction& instruction, uint16_t pc, bool shiftUsesVy, bool& ends)
+{
+    auto x = instruction.x;
+    auto y = instruction.y;
+    auto nn = instruction.nn;
+    auto nnn = instruction.nnn;
+    auto next = static_cast<uint16_t>(pc + 2);
+    int cycles = 0;
+    ends = false;
+
+    switch (instruction.op)
+    {
+        case Op::SetRegisterVxToNn:
+            e.countInstruction();
+            e.bytes({ 0xC6, 0x46, x, nn });                 // mov byte [rsi+x], nn
+            cycles = 27;
+            break;
+        case Op::AddNnToRegisterVx:
+            e.countInstruction();
+            e.bytes({ 0x80, 0x46, x, nn });                 // add byte [rsi+x], nn
+            cycles = 45;
+            break;
+        case Op::SetVxToValueOfVy:
+        case Op::BinaryOr:
+        case Op::BinaryAnd:
+        case Op::BinaryXor:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.loadVyToEcx(y);
+            switch (instruction.op) {
+                case Op::SetVxToValueOfVy: e.bytes({ 0x89, 0xC8 }); break; // mov eax, ecx
+                case Op::BinaryOr: e.bytes({ 0x08, 0xC8 }); break;         // or al, cl
+                case Op::BinaryAnd: e.bytes({ 0x20, 0xC8 }); break;        // and al, cl
+                default: e.bytes({ 0x30, 0xC8 }); break;                   // xor al, cl
+            }
+            e.storeAl(x);
+            cycles = 200;
+            break;
+        case Op::AddWithCarry:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.loadVyToEcx(y);
+            e.bytes({ 0x01, 0xC8 });                        // add eax, ecx
+            e.bytes({ 0x3D });                              // cmp eax, 255
+            e.dword(255);
+            e.setAboveToDl();
+            e.storeDl(0xF);
+            e.storeAl(x);
+            cycles = 200;
+            break;
+        case Op::SubtractVyFromVx:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.loadVyToEcx(y);
+            e.bytes({ 0x39, 0xC8 });                        // cmp eax, ecx
+            e.setAboveToDl();
+            e.bytes({ 0x28, 0xC8 });                        // sub al, cl
+            e.storeAl(x);
+            e.storeDl(0xF);
+            cycles = 200;
+            break;
+        case Op::SubtractVxFromVy:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.loadVyToEcx(y);
+            e.bytes({ 0x39, 0xC1 });                        // cmp ecx, eax
+            e.setAboveToDl();
+            e.bytes({ 0x28, 0xC1 });                        // sub cl, al
+            e.storeCl(x);
+            e.storeDl(0xF);
+            cycles = 200;
+            break;
+        case Op::ShiftRight:
+            e.countInstruction();
+            e.loadVxToEax(shiftUsesVy ? y : x);
+            e.bytes({ 0x89, 0xC2 });                        // mov edx, eax
+            e.bytes({ 0x83, 0xE2, 0x01 });                  // and edx, 1
+            e.bytes({ 0xD0, 0xE8 });                        // shr al, 1
+            e.storeAl(x);
+            e.storeDl(0xF);
+            cycles = 200;
+            break;
+        case Op::ShiftLeft:
+            e.countInstruction();
+            e.loadVxToEax(shiftUsesVy ? y : x);
+            e.bytes({ 0x89, 0xC2 });                        // mov edx, eax
+            e.bytes({ 0xC1, 0xEA, 0x07 });                  // shr edx, 7
+            e.bytes({ 0xD0, 0xE0 });                        // shl al, 1
+            e.storeAl(x);
+            e.storeDl(0xF);
+            cycles = 200;
+            break;
+        case Op::SetIndexRegister:
+            e.countInstruction();
+            e.bytes({ 0x66, 0xC7, 0x47, INDEX });           // mov word [rdi+INDEX], nnn
+            e.word(nnn);
+            cycles = 55;
+            break;
+        case Op::AddToIndex:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.bytes({ 0x66, 0x01, 0x47, INDEX });           // add word [rdi+INDEX], ax
+            cycles = 86;
+            break;
+        case Op::GetDelayTimer:
+            e.countInstruction();
+            e.bytes({ 0x0F, 0xB6, 0x47, DELAY_TIMER });     // movzx eax, byte [rdi+DELAY_TIMER]
+            e.storeAl(x);
+            cycles = 45;
+            break;
+        case Op::SetDelayTimer:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.bytes({ 0x88, 0x47, DELAY_TIMER });           // mov [rdi+DELAY_TIMER], al
+            cycles = 45;
+            break;
+        case Op::SkipIfVxEqualsNn:
+        case Op::SkipIfVxNotEqualsNn:
+            e.countInstruction();
+            e.bytes({ 0x80, 0x7E, x, nn });                 // cmp byte [rsi+x], nn
+            e.skip(instruction.op == Op::SkipIfVxEqualsNn ? JNE : JE, pc, 55);
+            ends = true;
+            return true;
+        case Op::SkipIfVxEqualsVy:
+        case Op::SkipIfVxNotEqualsVy:
+            e.countInstruction();
+            e.loadVxToEax(x);
+            e.bytes({ 0x3A, 0x46, y });                     // cmp al, byte [rsi+y]
+            if(instruction.op == Op::SkipIfVxEqualsVy) {
+                e.skip(JNE, pc, 55);
+            } else {
+                e.skip(JE, pc, 73);
+            }
+            ends = true;
+            return true;
+        case Op::Jump:
+            e.countInstruction();
+            e.charge(105);
+            e.leave(nnn);
+            ends = true;
+            return true;
+        default:
+            return false;
+    }
+
+    e.charge(cycles);
+    e.continueWithBudget(next);
+    return true;
+}
+
+Recompiler::Recompiler()
+    : _used(0)
+    , _instructionCost(0)
+    , _shiftUsesVy(false)
+{
+    // never writable and executable at once, see compile
+    void* arena = mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    _arena = arena == MAP_FAILED ? nullptr : static_cast<uint8_t*>(arena);
+    invalidate();
+}
+
+Recompiler::~Recompiler()
+{
+    if(_arena != nullptr) {
+        munmap(_arena, ARENA_SIZE);
+    }
+}
+
+Recompiler::Code Recompiler::lookup(uint16_t pc, Memory& memory)
+{
+    if((pc & 1) != 0 || pc >= RAM_SIZE || _arena == nullptr) {
+        return nullptr;
+    }
+    auto& region = _regions[pc >> 1];
+    if(!region.compiled && ++region.hits >= HOT_THRESHOLD) {
+        compile(pc, memory, region);
+    }
+    return region.code;
+}
+
+void Recompiler::compile(uint16_t pc, Memory& memory, Region& region)
+{
+    Emitter e(pc, _instructionCost);
+    auto addr = pc;
+    auto ends = false;
+    auto length = 0;
+    while(!ends && length < MAX_LENGTH && addr + 1 < RAM_SIZE) {
+        auto instruction = Decoder::decodeInstruction(memory.get(addr) << 8 | memory.get(addr + 1));
+        if(isSkip(instruction.op) && memory.get(addr + 2) == 0xF0 && memory.get(addr + 3) == 0x00) {
+            // skips all four bytes of XO-CHIP's F000 NNNN
+            break;
+        }
+        if(!emit(e, instruction, addr, _shiftUsesVy, ends)) {
+            break;
+        }
+        addr += 2;
+        length++;
+    }
+    if(!ends) {
+        e.exit(addr);
+    }
+
+    // a skip at the end also depends on the instruction after it
+    uint16_t end = ends ? addr + 2 : addr;
+    region.compiled = true;
+    region.end = end;
+    region.code = nullptr;
+    if(length == 0) {
+        return;
+    }
+    if(_used + e.code.size() > ARENA_SIZE) {
+        // start over with an empty arena, every region is compiled again
+        invalidate();
+        region.compiled = true;
+        region.end = end;
+    }
+    // the pages the code goes to are made writable for the copy and
+    // executable again after it
+    static const uintptr_t PAGE_MASK = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+    auto first = reinterpret_cast<uintptr_t>(_arena + _used) & ~PAGE_MASK;
+    auto last = (reinterpret_cast<uintptr_t>(_arena + _used + e.code.size()) + PAGE_MASK) & ~PAGE_MASK;
+    auto pages = reinterpret_cast<void*>(first);
+    if(mprotect(pages, last - first, PROT_READ | PROT_WRITE) != 0) {
+        return;
+    }
+    memcpy(_arena + _used, e.code.data(), e.code.size());
+    if(mprotect(pages, last - first, PROT_READ | PROT_EXEC) != 0) {
+        return;
+    }
+    region.code = reinterpret_cast<Code>(_arena + _used);
+    _used += e.code.size();
+}
+
+void Recompiler::setInstructionCost(int32_t cost)
+{
+    if(cost != _instructionCost) {
+        _instructionCost = cost;
+        invalidate();
+    }
+}
+
+void Recompiler::setShiftUsesVy(bool shiftUsesVy)
+{
+    if(shiftUsesVy != _shiftUsesVy) {
+        _shiftUsesVy = shiftUsesVy;
+        invalidate();
+    }
+}
+
+void Recompiler::invalidate()
+{
+    _used = 0;
+    for (auto& region : _regions) {
+        region.code = nullptr;
+        region.end = 0;
+        region.hits = 0;
+        region.compiled = false;
+    }
+}
+
+void Recompiler::onMemoryWritten(uint16_t addr, uint16_t length)
+{
+    int first = (addr - MAX_LENGTH * 2) >> 1;
+    if(first < 0) {
+        first = 0;
+    }
+    int last = (addr + length - 1) >> 1;
+    if(last >= RAM_SIZE / 2) {
+        last = RAM_SIZE / 2 - 1;
+    }
+    uint32_t end = addr + length;
+    for (int slot = first; slot <= last; slot++) {
+        auto& region = _regions[slot];
+        // regions that could not be compiled cover the first instruction
+        auto regionEnd = region.end > slot * 2 ? region.end : slot * 2 + 2;
+        if(region.compiled && slot * 2 < static_cast<int>(end) && regionEnd > addr) {
+            region.code = nullptr;
+            region.hits = 0;
+            region.compiled = false;
+        }
+    }
+}
+#endif
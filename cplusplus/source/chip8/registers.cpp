@@ -13,13 +13,3 @@ Registers::Registers()
 Registers::~Registers()
 {
 }
-
-void Registers::set(uint8_t index, uint8_t value) 
-{
-    _registers[index] = value;
-}
-
-uint8_t Registers::get(uint8_t index) 
-{
-    return _registers[index];
-}
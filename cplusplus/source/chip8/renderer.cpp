@@ -0,0 +1,103 @@
+#include "chip8/renderer.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Chip8;
+
+Renderer::Renderer(int scale, Palette palette)
+    : _scale(scale)
+    , _palette(palette)
+{
+}
+
+Renderer::~Renderer()
+{
+    if(_texture != nullptr) {
+        SDL_DestroyTexture(_texture);
+    }
+    if(_renderer != nullptr) {
+        SDL_DestroyRenderer(_renderer);
+    }
+    if(_window != nullptr) {
+        SDL_DestroyWindow(_window);
+    }
+}
+
+bool Renderer::init()
+{
+    _window = SDL_CreateWindow("CHIP-8",
+        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+        COLS * _scale, ROWS * _scale, SDL_WINDOW_SHOWN);
+    if(_window == nullptr) {
+        printf( "Window could not be created! SDL_Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    _renderer = SDL_CreateRenderer(_window, -1, 0);
+    if(_renderer == nullptr) {
+        printf( "Renderer could not be created! SDL_Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    // keep the pixels sharp when SDL scales the texture up
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    SDL_RenderSetLogicalSize(_renderer, COLS, ROWS);
+    _texture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING, HIRES_COLS, HIRES_ROWS);
+    if(_texture == nullptr) {
+        printf( "Texture could not be created! SDL_Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    _dirty = true;
+    return true;
+}
+
+void Renderer::setPalette(Palette palette)
+{
+    _palette = palette;
+    _dirty = true;
+}
+
+void Renderer::present(const uint64_t* planes, bool hires)
+{
+    if(hires != _hires) {
+        _hires = hires;
+        _dirty = true;
+        if(_renderer != nullptr) {
+            SDL_RenderSetLogicalSize(_renderer, getWidth(), getHeight());
+        }
+    }
+    int width = getWidth();
+    int height = getHeight();
+    int words = hires ? 2 : 1;
+    // comparing the 256 or 1024 bytes of each plane is as cheap as hashing
+    // them
+    auto bytes = height * words * sizeof(uint64_t);
+    auto second = planes + FRAME_WORDS;
+    if(_dirty || memcmp(planes, _planes, bytes) != 0 || memcmp(second, _planes + FRAME_WORDS, bytes) != 0) {
+        memcpy(_planes, planes, bytes);
+        memcpy(_planes + FRAME_WORDS, second, bytes);
+        const uint32_t colors[] = {
+            _palette.background, _palette.foreground, _palette.secondPlane, _palette.bothPlanes
+        };
+        for(int y = 0; y < height; y++) {
+            for(int x = 0; x < width; x++) {
+                auto word = y * words + x / 64;
+                auto shift = 63 - x % 64;
+                auto color = ((planes[word] >> shift) & 1) | ((second[word] >> shift) & 1) << 1;
+                _pixels[y * width + x] = colors[color];
+            }
+        }
+        if(_texture != nullptr) {
+            SDL_Rect area = { 0, 0, width, height };
+            SDL_UpdateTexture(_texture, &area, _pixels, width * sizeof(uint32_t));
+        }
+        _uploads++;
+        _dirty = false;
+    }
+
+    if(_renderer != nullptr) {
+        SDL_Rect area = { 0, 0, getWidth(), getHeight() };
+        SDL_RenderClear(_renderer);
+        SDL_RenderCopy(_renderer, _texture, &area, nullptr);
+        SDL_RenderPresent(_renderer);
+    }
+}
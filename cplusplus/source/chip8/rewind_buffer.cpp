@@ -0,0 +1,187 @@
+#include "chip8/rewind_buffer.h"
+#include "chip8/snapshot.h"
+#include <cstring>
+
+using namespace std;
+using namespace Chip8;
+
+// Runs of fewer equal bytes than this are cheaper to keep as literals than
+// to end the literal run for.
+static const size_t MIN_ZERO_RUN = 3;
+
+static uint8_t* bytes(Snapshot& snapshot)
+{
+    return reinterpret_cast<uint8_t*>(&snapshot);
+}
+
+static uint64_t word(const uint8_t* data, size_t offset)
+{
+    uint64_t value;
+    memcpy(&value, data + offset, sizeof(value));
+    return value;
+}
+
+static size_t writeLength(uint8_t* out, size_t length)
+{
+    size_t size = 0;
+    while(length >= 0x80) {
+        out[size++] = static_cast<uint8_t>(length | 0x80);
+        length >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(length);
+    return size;
+}
+
+static size_t readLength(const uint8_t*& in)
+{
+    size_t length = 0;
+    int shift = 0;
+    while(*in & 0x80) {
+        length |= static_cast<size_t>(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return length | static_cast<size_t>(*in++) << shift;
+}
+
+RewindBuffer::RewindBuffer(size_t capacity)
+    : _newest(make_unique<Snapshot>())
+    , _next(make_unique<Snapshot>())
+    , _hasState(false)
+    // two lengths per run of differing bytes, at most 3 bytes each
+    , _scratch(sizeof(Snapshot) * 2 + 16)
+    , _ring(capacity)
+    , _head(0)
+{
+}
+
+RewindBuffer::~RewindBuffer()
+{
+}
+
+size_t RewindBuffer::getUsedBytes() const
+{
+    size_t used = 0;
+    for(auto& delta : _deltas) {
+        used += delta.size;
+    }
+    return used;
+}
+
+void RewindBuffer::record(const CPU& cpu, const Display& display, const Keyboard& keyboard)
+{
+    _next->save(cpu, display, keyboard);
+    if(_hasState && _next->ramSize == _newest->ramSize) {
+        push(encode(bytes(*_next), bytes(*_newest), _next->getLength()));
+    } else {
+        // older states of another size of memory cannot be reached
+        _deltas.clear();
+        _head = 0;
+    }
+    swap(_newest, _next);
+    _hasState = true;
+}
+
+bool RewindBuffer::rewind(CPU& cpu, Display& display, Keyboard& keyboard)
+{
+    if(_deltas.empty()) {
+        return false;
+    }
+    auto delta = _deltas.back();
+    _deltas.pop_back();
+    _head = delta.offset;
+    decode(delta, bytes(*_newest));
+    return _newest->restore(cpu, display, keyboard);
+}
+
+// Writes the first length bytes of newer ^ older to the scratch buffer as
+// pairs of a run of zeros and a run of literal bytes, each preceded by its
+// length.
+size_t RewindBuffer::encode(const uint8_t* newer, const uint8_t* older, size_t length)
+{
+    auto out = _scratch.data();
+    size_t size = 0;
+    size_t i = 0;
+    while(i < length) {
+        auto zeros = i;
+        while(i + sizeof(uint64_t) <= length && word(newer, i) == word(older, i)) {
+            i += sizeof(uint64_t);
+        }
+        while(i < length && newer[i] == older[i]) {
+            i++;
+        }
+        if(i == length) {
+            break;
+        }
+        zeros = i - zeros;
+
+        auto literals = i;
+        while(i < length) {
+            if(newer[i] != older[i]) {
+                i++;
+                continue;
+            }
+            auto same = i;
+            while(same < length && same - i < MIN_ZERO_RUN && newer[same] == older[same]) {
+                same++;
+            }
+            if(same - i >= MIN_ZERO_RUN || same == length) {
+                break;
+            }
+            i = same;
+        }
+
+        size += writeLength(out + size, zeros);
+        size += writeLength(out + size, i - literals);
+        for(auto j = literals; j < i; j++) {
+            out[size++] = newer[j] ^ older[j];
+        }
+    }
+    return size;
+}
+
+void RewindBuffer::decode(const Delta& delta, uint8_t* state) const
+{
+    const uint8_t* in = _ring.data() + delta.offset;
+    auto end = in + delta.size;
+    size_t i = 0;
+    while(in < end) {
+        i += readLength(in);
+        auto literals = readLength(in);
+        for(size_t j = 0; j < literals; j++) {
+            state[i++] ^= *in++;
+        }
+    }
+}
+
+// Copies the encoded delta into the ring. A delta never wraps around the end
+// of the ring; when it does not fit in front of the end it goes to the start
+// and the rest of the ring is left unused for this round.
+void RewindBuffer::push(size_t size)
+{
+    if(size > _ring.size()) {
+        // too big to keep, and older states cannot be reached without it
+        _deltas.clear();
+        _head = 0;
+        return;
+    }
+
+    auto offset = _head;
+    bool wrapped = offset + size > _ring.size();
+    if(wrapped) {
+        offset = 0;
+    }
+    while(!_deltas.empty()) {
+        auto& oldest = _deltas.front();
+        bool overlaps = oldest.offset < offset + size && offset < oldest.offset + oldest.size;
+        // deltas between the old head and the end are older than any at the start
+        bool skipped = wrapped && oldest.offset >= _head;
+        if(!overlaps && !skipped) {
+            break;
+        }
+        _deltas.pop_front();
+    }
+
+    memcpy(_ring.data() + offset, _scratch.data(), size);
+    _deltas.push_back({ offset, size });
+    _head = offset + size;
+}
@@ -0,0 +1,102 @@
+#include "chip8/rom.h"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#endif
+
+using namespace Chip8;
+
+char const* Chip8::describe(RomError error)
+{
+    switch(error) {
+        case RomError::None:
+            return "no error";
+        case RomError::CanNotOpen:
+            return "can not be opened";
+        case RomError::NotAFile:
+            return "is not a file";
+        case RomError::Empty:
+            return "is empty";
+        case RomError::CanNotMap:
+            return "can not be mapped";
+        case RomError::TooLarge:
+            return "does not fit in memory";
+    }
+    return "unknown error";
+}
+
+Rom::~Rom()
+{
+    close();
+}
+
+#if !defined(_WIN32)
+RomError Rom::open(char const* filename)
+{
+    close();
+    int file = ::open(filename, O_RDONLY);
+    if(file < 0) {
+        return RomError::CanNotOpen;
+    }
+    struct stat status;
+    if(fstat(file, &status) != 0 || !S_ISREG(status.st_mode)) {
+        ::close(file);
+        return RomError::NotAFile;
+    }
+    if(status.st_size == 0) {
+        ::close(file);
+        return RomError::Empty;
+    }
+    auto size = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps the file open by itself
+    ::close(file);
+    if(mapped == MAP_FAILED) {
+        return RomError::CanNotMap;
+    }
+    _data = static_cast<const uint8_t*>(mapped);
+    _size = size;
+    return RomError::None;
+}
+
+void Rom::close()
+{
+    if(_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    _data = nullptr;
+    _size = 0;
+}
+#else
+RomError Rom::open(char const* filename)
+{
+    close();
+    auto file = fopen(filename, "rb");
+    if(file == nullptr) {
+        return RomError::CanNotOpen;
+    }
+    uint8_t chunk[4096];
+    size_t read;
+    while((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        _buffer.insert(_buffer.end(), chunk, chunk + read);
+    }
+    fclose(file);
+    if(_buffer.empty()) {
+        return RomError::Empty;
+    }
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return RomError::None;
+}
+
+void Rom::close()
+{
+    _data = nullptr;
+    _size = 0;
+    _buffer.clear();
+}
+#endif
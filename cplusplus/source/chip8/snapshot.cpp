@@ -0,0 +1,70 @@
+#include "chip8/snapshot.h"
+#include "chip8/registers.h"
+#include "chip8/display.h"
+#include "chip8/keyboard.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Chip8;
+
+void Snapshot::save(const CPU& cpu, const Display& display, const Keyboard& keyboard)
+{
+    magic = MAGIC;
+    version = VERSION;
+    size = sizeof(Snapshot);
+    ramSize = cpu._memory->getSize();
+    keys = keyboard.getState();
+    lastKeys = keyboard.getLastState();
+    hires = display.isHires();
+    selectedPlanes = display.getSelectedPlanes();
+    instructionCount = cpu._instructionCount;
+    this->cpu = cpu._state;
+    memcpy(registers, cpu._registers->data(), sizeof(registers));
+    memcpy(planes, display.getPlanes(), sizeof(planes));
+    memcpy(ram, cpu._memory->data(), ramSize);
+}
+
+bool Snapshot::restore(CPU& cpu, Display& display, Keyboard& keyboard) const
+{
+    if(magic != MAGIC || version != VERSION || size != sizeof(Snapshot) || ramSize != cpu._memory->getSize()) {
+        return false;
+    }
+    keyboard.setState(keys);
+    keyboard.setLastState(lastKeys);
+    cpu._instructionCount = instructionCount;
+    cpu._state = this->cpu;
+    memcpy(cpu._registers->data(), registers, sizeof(registers));
+    display.setHires(hires);
+    display.selectPlanes(selectedPlanes);
+    display.setPlanes(&planes[0][0]);
+    // the restored picture has not been shown yet
+    display.setDrawFlag(true);
+    cpu._memory->restore(0, ram, ramSize);
+    return true;
+}
+
+bool Snapshot::write(char const* filename) const
+{
+    auto file = fopen(filename, "wb");
+    if(file == nullptr) {
+        printf("Could not open %s for writing\n", filename);
+        return false;
+    }
+    auto written = fwrite(this, getLength(), 1, file);
+    fclose(file);
+    return written == 1;
+}
+
+bool Snapshot::read(char const* filename)
+{
+    auto file = fopen(filename, "rb");
+    if(file == nullptr) {
+        printf("Could not open %s\n", filename);
+        return false;
+    }
+    auto read = fread(this, offsetof(Snapshot, ram), 1, file) == 1
+        && magic == MAGIC && version == VERSION && size == sizeof(Snapshot) && ramSize <= XO_RAM_SIZE
+        && fread(ram, ramSize, 1, file) == 1;
+    fclose(file);
+    return read;
+}
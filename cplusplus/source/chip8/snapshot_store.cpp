@@ -0,0 +1,159 @@
+#include "chip8/snapshot_store.h"
+#include "chip8/snapshot.h"
+#include "chip8/registers.h"
+#include "chip8/display.h"
+#include "chip8/keyboard.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+using namespace Chip8;
+
+static_assert(sizeof(uint64_t) * PLANES * FRAME_WORDS == SnapshotStore::FRAME_PAGES * SnapshotStore::PAGE_SIZE, "the framebuffer must fill whole pages");
+
+SnapshotStore::Id SnapshotStore::save(const CPU& cpu, const Display& display, const Keyboard& keyboard, Id parent)
+{
+    if(parent != NONE && !isLive(parent)) {
+        return NONE;
+    }
+    auto ramPages = cpu._memory->getSize() / PAGE_SIZE;
+    if(_states.size() == _freeStates.size()) {
+        _pageCount = FRAME_PAGES + ramPages;
+        _pageTables.resize(_states.size() * _pageCount);
+    } else if(_pageCount != FRAME_PAGES + ramPages) {
+        printf("Can not store a machine with %u bytes of memory among others\n", cpu._memory->getSize());
+        return NONE;
+    }
+
+    auto id = allocateState();
+    auto& state = _states[id];
+    state.cpu = cpu._state;
+    state.instructionCount = cpu._instructionCount;
+    memcpy(state.registers, cpu._registers->data(), sizeof(state.registers));
+    state.keys = keyboard.getState();
+    state.lastKeys = keyboard.getLastState();
+    state.hires = display.isHires();
+    state.selectedPlanes = display.getSelectedPlanes();
+
+    auto frame = reinterpret_cast<const uint8_t*>(display.getPlanes());
+    const uint8_t* ram = cpu._memory->data();
+    auto table = pages(id);
+    for(uint32_t i = 0; i < _pageCount; i++) {
+        auto data = i < FRAME_PAGES ? frame + i * PAGE_SIZE : ram + (i - FRAME_PAGES) * PAGE_SIZE;
+        if(parent != NONE) {
+            auto shared = pages(parent)[i];
+            if(memcmp(page(shared), data, PAGE_SIZE) == 0) {
+                _pageRefs[shared]++;
+                table[i] = shared;
+                continue;
+            }
+        }
+        table[i] = allocatePage(data);
+    }
+    return id;
+}
+
+SnapshotStore::Id SnapshotStore::fork(Id state)
+{
+    if(!isLive(state)) {
+        return NONE;
+    }
+    auto id = allocateState();
+    _states[id] = _states[state];
+    auto table = pages(id);
+    memcpy(table, pages(state), _pageCount * sizeof(uint32_t));
+    for(uint32_t i = 0; i < _pageCount; i++) {
+        _pageRefs[table[i]]++;
+    }
+    return id;
+}
+
+bool SnapshotStore::restore(Id id, CPU& cpu, Display& display, Keyboard& keyboard) const
+{
+    if(!isLive(id) || _pageCount != FRAME_PAGES + cpu._memory->getSize() / PAGE_SIZE) {
+        return false;
+    }
+    auto& state = _states[id];
+    cpu._state = state.cpu;
+    cpu._instructionCount = state.instructionCount;
+    memcpy(cpu._registers->data(), state.registers, sizeof(state.registers));
+    keyboard.setState(state.keys);
+    keyboard.setLastState(state.lastKeys);
+
+    auto table = pages(id);
+    uint64_t frame[PLANES * FRAME_WORDS];
+    for(uint16_t i = 0; i < FRAME_PAGES; i++) {
+        memcpy(reinterpret_cast<uint8_t*>(frame) + i * PAGE_SIZE, page(table[i]), PAGE_SIZE);
+    }
+    display.setHires(state.hires);
+    display.selectPlanes(state.selectedPlanes);
+    display.setPlanes(frame);
+    display.setDrawFlag(true);
+    for(uint32_t i = FRAME_PAGES; i < _pageCount; i++) {
+        cpu._memory->restore(static_cast<uint16_t>((i - FRAME_PAGES) * PAGE_SIZE), page(table[i]), PAGE_SIZE);
+    }
+    return true;
+}
+
+bool SnapshotStore::release(Id id)
+{
+    if(!isLive(id)) {
+        return false;
+    }
+    auto table = pages(id);
+    for(uint32_t i = 0; i < _pageCount; i++) {
+        if(--_pageRefs[table[i]] == 0) {
+            _freePages.push_back(table[i]);
+        }
+    }
+    _states[id].live = false;
+    _freeStates.push_back(id);
+    return true;
+}
+
+StoreUsage SnapshotStore::getUsage() const
+{
+    StoreUsage usage;
+    usage.states = static_cast<uint32_t>(_states.size() - _freeStates.size());
+    usage.pages = static_cast<uint32_t>(_pageRefs.size() - _freePages.size());
+    usage.bytes = _states.capacity() * sizeof(State)
+        + _freeStates.capacity() * sizeof(Id)
+        + _pageTables.capacity() * sizeof(uint32_t)
+        + _pageData.capacity()
+        + _pageRefs.capacity() * sizeof(uint32_t)
+        + _freePages.capacity() * sizeof(uint32_t);
+    auto ramSize = _pageCount > FRAME_PAGES ? (_pageCount - FRAME_PAGES) * PAGE_SIZE : 0;
+    usage.flatBytes = static_cast<uint64_t>(usage.states) * (offsetof(Snapshot, ram) + ramSize);
+    return usage;
+}
+
+SnapshotStore::Id SnapshotStore::allocateState()
+{
+    Id id;
+    if(_freeStates.empty()) {
+        id = static_cast<Id>(_states.size());
+        _states.emplace_back();
+        _pageTables.resize(_states.size() * _pageCount);
+    } else {
+        id = _freeStates.back();
+        _freeStates.pop_back();
+    }
+    _states[id].live = true;
+    return id;
+}
+
+uint32_t SnapshotStore::allocatePage(const uint8_t* data)
+{
+    uint32_t page;
+    if(_freePages.empty()) {
+        page = static_cast<uint32_t>(_pageRefs.size());
+        _pageRefs.push_back(0);
+        _pageData.resize(_pageData.size() + PAGE_SIZE);
+    } else {
+        page = _freePages.back();
+        _freePages.pop_back();
+    }
+    _pageRefs[page] = 1;
+    memcpy(&_pageData[page * PAGE_SIZE], data, PAGE_SIZE);
+    return page;
+}
@@ -0,0 +1,24 @@
+#include "chip8/timing.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace Chip8;
+
+bool Timing::parse(char const* text, Timing& timing)
+{
+    if(strcmp(text, "vip") == 0) {
+        timing = vip();
+        return true;
+    }
+    if(strcmp(text, "fast") == 0) {
+        timing = unlimited();
+        return true;
+    }
+    char* end;
+    auto rate = strtoul(text, &end, 10);
+    if(*end != '\0' || rate == 0 || rate > INT32_MAX) {
+        return false;
+    }
+    timing = fixed(static_cast<uint32_t>(rate));
+    return true;
+}
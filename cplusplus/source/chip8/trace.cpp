@@ -0,0 +1,62 @@
+#include "chip8/trace.h"
+
+using namespace Chip8;
+
+TraceRecord Trace::_records[Trace::CAPACITY];
+std::atomic<uint32_t> Trace::_head(0);
+std::atomic<uint32_t> Trace::_tail(0);
+std::atomic<uint64_t> Trace::_dropped(0);
+std::atomic<TraceLevel> Trace::_level(TraceLevel::Debug);
+std::atomic<uint32_t> Trace::_categories(0xFFFFFFFF);
+
+static char const* LEVEL_NAMES[] = { "error", "info", "debug" };
+static char const* CATEGORY_NAMES[] = { "fetch", "decode", "memory", "display", "input" };
+
+void Trace::enableCategory(TraceCategory category, bool enabled)
+{
+    auto bit = 1u << static_cast<uint8_t>(category);
+    if(enabled) {
+        _categories.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        _categories.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void Trace::write(
+    TraceLevel level,
+    TraceCategory category,
+    char const* format,
+    int arg0, int arg1, int arg2, int arg3)
+{
+    auto head = _head.load(std::memory_order_relaxed);
+    auto tail = _tail.load(std::memory_order_acquire);
+    if(head - tail >= CAPACITY) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto& record = _records[head % CAPACITY];
+    record.level = level;
+    record.category = category;
+    record.format = format;
+    record.args[0] = arg0;
+    record.args[1] = arg1;
+    record.args[2] = arg2;
+    record.args[3] = arg3;
+    _head.store(head + 1, std::memory_order_release);
+}
+
+uint32_t Trace::drain(FILE* file)
+{
+    auto tail = _tail.load(std::memory_order_relaxed);
+    auto head = _head.load(std::memory_order_acquire);
+    for(auto i = tail; i != head; i++) {
+        auto& record = _records[i % CAPACITY];
+        fprintf(file, "[%s][%s] ",
+            LEVEL_NAMES[static_cast<uint8_t>(record.level)],
+            CATEGORY_NAMES[static_cast<uint8_t>(record.category)]);
+        fprintf(file, record.format, record.args[0], record.args[1], record.args[2], record.args[3]);
+        fputc('\n', file);
+    }
+    _tail.store(head, std::memory_order_release);
+    return head - tail;
+}
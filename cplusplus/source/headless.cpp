@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "chip8/cpu.h"
+#include "chip8/batch_cpu.h"
+#include "chip8/emulator_pool.h"
+#include "chip8/frame_pacer.h"
+#include "chip8/memory.h"
+#include "chip8/registers.h"
+#include "chip8/display.h"
+#include "chip8/keyboard.h"
+#include "chip8/audio.h"
+#include "chip8/rewind_buffer.h"
+#include "chip8/movie.h"
+#include "chip8/timing.h"
+#include "chip8/quirks.h"
+#include "chip8/trace.h"
+
+// Runs one or more ROMs without initializing SDL for a number of frames, or
+// until a number of instructions has been executed, and reports the
+// achieved instructions per second. The display is never initialized, so it only
+// keeps the framebuffer in memory, and the keyboard never sees any input
+// unless a movie is replayed.
+// With --instances every ROM runs on that many machines at once, spread over
+// --threads worker threads (all hardware threads by default). With --lockstep
+// every ROM runs on that many lanes of one BatchCPU instead. With --paced
+// frames run in real time at 60 Hz and pacing statistics are printed;
+// --speed X scales that rate. --rewind MB records every frame into a rewind
+// buffer of that size and reports what it costs.
+//
+// --seed N seeds the random number generator, and --replay FILE plays back a
+// movie recorded by the SDL frontend, with the movie's seed, timing and
+// quirks, for as many frames as it holds. Both make the run deterministic and print a hash of
+// the final framebuffer to compare runs by.
+//
+// --timing vip|fast|IPS picks how many instructions run per frame, see
+// Chip8::Timing. The default is the COSMAC VIP. --quirks picks a profile of
+// Chip8::Quirks.
+//
+// --wav FILE mixes the sound of every frame, one frame's worth of samples
+// after the frame, and writes it to FILE, so that two runs can be compared
+// byte for byte.
+
+// Prints why a ROM could not be loaded.
+static bool load(char const* filename, Chip8::RomError error)
+{
+    if(error != Chip8::RomError::None) {
+        printf("%s %s\n", filename, Chip8::describe(error));
+        return false;
+    }
+    return true;
+}
+
+static void usage(char const* name)
+{
+    printf("Usage: %s [--frames N | --cycles N] [--single-step | --recompile] [--paced [--speed X]]\n"
+        "       [--timing vip|fast|IPS] [--quirks default|chip8|schip|xochip]\n"
+        "       [--rewind MB] [--seed N | --replay FILE]\n"
+        "       [--instances N [--threads N] | --lockstep N | --wav FILE] rom...\n", name);
+}
+
+// FNV-1a of the rows of the current resolution. Planes other than the
+// first only count once something was drawn to them, so CHIP-8 hashes do
+// not depend on how many planes there are.
+static uint64_t hashRows(const Chip8::Display& display)
+{
+    auto words = display.getHeight() * display.getRowWords();
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for(int plane = 0; plane < Chip8::PLANES; plane++) {
+        auto rows = display.getPlane(plane);
+        if(plane > 0 && std::all_of(rows, rows + words, [](uint64_t row) { return row == 0; })) {
+            continue;
+        }
+        for(int row = 0; row < words; row++) {
+            for(int byte = 0; byte < 8; byte++) {
+                hash = (hash ^ ((rows[row] >> (byte * 8)) & 0xFF)) * 0x100000001B3ull;
+            }
+        }
+    }
+    return hash;
+}
+
+static void report(char const* rom, uint64_t frames, uint64_t instructions, double seconds)
+{
+    printf("%-40s %12llu %14llu %10.4f %14.0f\n",
+        rom,
+        static_cast<unsigned long long>(frames),
+        static_cast<unsigned long long>(instructions),
+        seconds,
+        seconds > 0 ? instructions / seconds : 0.0);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t frames = 600;
+    uint64_t cycles = 0;
+    bool singleStep = false;
+    bool recompile = false;
+    bool paced = false;
+    double speed = 1.0;
+    size_t instances = 0;
+    unsigned int threads = 0;
+    size_t lanes = 0;
+    size_t rewindBytes = 0;
+    bool seeded = false;
+    uint32_t seed = 0;
+    std::unique_ptr<Chip8::Movie> movie;
+    char const* wavFilename = nullptr;
+    auto timing = Chip8::Timing::vip();
+    Chip8::Quirks quirks;
+    bool timingGiven = false;
+    bool quirksGiven = false;
+    int first = 1;
+
+    while(first < argc && argv[first][0] == '-') {
+        if(strcmp(argv[first], "--single-step") == 0) {
+            singleStep = true;
+            first++;
+            continue;
+        }
+        if(strcmp(argv[first], "--paced") == 0) {
+            paced = true;
+            first++;
+            continue;
+        }
+        if(strcmp(argv[first], "--recompile") == 0) {
+            recompile = true;
+            first++;
+            continue;
+        }
+        if(strcmp(argv[first], "--frames") == 0 && first + 1 < argc) {
+            frames = strtoull(argv[first + 1], nullptr, 10);
+            cycles = 0;
+        } else if(strcmp(argv[first], "--cycles") == 0 && first + 1 < argc) {
+            cycles = strtoull(argv[first + 1], nullptr, 10);
+            frames = 0;
+        } else if(strcmp(argv[first], "--instances") == 0 && first + 1 < argc) {
+            instances = strtoull(argv[first + 1], nullptr, 10);
+        } else if(strcmp(argv[first], "--speed") == 0 && first + 1 < argc) {
+            speed = atof(argv[first + 1]);
+        } else if(strcmp(argv[first], "--lockstep") == 0 && first + 1 < argc) {
+            lanes = strtoull(argv[first + 1], nullptr, 10);
+        } else if(strcmp(argv[first], "--rewind") == 0 && first + 1 < argc) {
+            rewindBytes = static_cast<size_t>(atof(argv[first + 1]) * 1024 * 1024);
+        } else if(strcmp(argv[first], "--timing") == 0 && first + 1 < argc) {
+            if(!Chip8::Timing::parse(argv[first + 1], timing)) {
+                usage(argv[0]);
+                return 1;
+            }
+            timingGiven = true;
+        } else if(strcmp(argv[first], "--quirks") == 0 && first + 1 < argc) {
+            if(!Chip8::Quirks::parse(argv[first + 1], quirks)) {
+                usage(argv[0]);
+                return 1;
+            }
+            quirksGiven = true;
+        } else if(strcmp(argv[first], "--seed") == 0 && first + 1 < argc) {
+            seed = strtoul(argv[first + 1], nullptr, 10);
+            seeded = true;
+        } else if(strcmp(argv[first], "--replay") == 0 && first + 1 < argc) {
+            movie = std::make_unique<Chip8::Movie>();
+            if(!movie->read(argv[first + 1])) {
+                return 1;
+            }
+            seed = movie->getSeed();
+            seeded = true;
+        } else if(strcmp(argv[first], "--wav") == 0 && first + 1 < argc) {
+            wavFilename = argv[first + 1];
+        } else if(strcmp(argv[first], "--threads") == 0 && first + 1 < argc) {
+            threads = strtoul(argv[first + 1], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        first += 2;
+    }
+    if(movie) {
+        if((timingGiven && timing != movie->getTiming()) || (quirksGiven && quirks != movie->getQuirks())) {
+            printf("The movie was recorded with other --timing or --quirks\n");
+            return 1;
+        }
+        timing = movie->getTiming();
+        quirks = movie->getQuirks();
+        frames = movie->getFrames();
+        cycles = 0;
+    }
+    if(first >= argc || ((instances > 0 || lanes > 0) && (cycles > 0 || movie))
+        || (wavFilename != nullptr && (instances > 0 || lanes > 0 || argc - first > 1))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%-40s %12s %14s %10s %14s\n", "rom", "frames", "instructions", "seconds", "ips");
+    for(int i = first; i < argc; i++) {
+        if(lanes > 0) {
+            Chip8::BatchCPU batch(lanes);
+            batch.setTiming(timing);
+            batch.setQuirks(quirks);
+            if(!load(argv[i], batch.loadROM(argv[i]))) {
+                return 1;
+            }
+            for(size_t lane = 0; seeded && lane < batch.getSize(); lane++) {
+                batch.seedRandom(lane, seed);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for(uint64_t frame = 0; frame < frames; frame++) {
+                batch.tick();
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            report(argv[i], frames * batch.getSize(), batch.getInstructionCount(),
+                std::chrono::duration<double>(end - start).count());
+            continue;
+        }
+
+        if(instances > 0) {
+            Chip8::EmulatorPool pool(instances, threads);
+            for(size_t m = 0; m < pool.getSize(); m++) {
+                pool.getMachine(m).cpu->setBlockExecution(!singleStep);
+                pool.getMachine(m).cpu->setRecompilation(recompile);
+                pool.getMachine(m).cpu->setTiming(timing);
+                pool.getMachine(m).cpu->setQuirks(quirks);
+                if(seeded) {
+                    pool.getMachine(m).cpu->seedRandom(seed);
+                }
+            }
+            if(!load(argv[i], pool.loadROM(argv[i]))) {
+                return 1;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            pool.runFrames(frames);
+            auto end = std::chrono::steady_clock::now();
+
+            report(argv[i], frames * pool.getSize(), pool.getInstructionCount(),
+                std::chrono::duration<double>(end - start).count());
+            continue;
+        }
+
+        auto memory = std::make_shared<Chip8::Memory>();
+        auto registers = std::make_shared<Chip8::Registers>();
+        auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+        cpu->setBlockExecution(!singleStep);
+        cpu->setRecompilation(recompile);
+        cpu->setTiming(timing);
+        cpu->setQuirks(quirks);
+        if(!load(argv[i], memory->loadROM(argv[i]))) {
+            return 1;
+        }
+        if(seeded) {
+            cpu->seedRandom(seed);
+        }
+        auto display = std::make_shared<Chip8::Display>();
+        auto keyboard = std::make_shared<Chip8::Keyboard>();
+        auto audio = std::make_shared<Chip8::Audio>();
+        std::unique_ptr<Chip8::RewindBuffer> rewind;
+        if(rewindBytes > 0) {
+            rewind = std::make_unique<Chip8::RewindBuffer>(rewindBytes);
+        }
+        std::chrono::steady_clock::duration recording {};
+        std::vector<int16_t> samples;
+        auto frameSamples = static_cast<size_t>(audio->getSampleRate() / 60);
+
+        Chip8::FramePacer pacer;
+        pacer.setSpeed(speed);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t frame = 0;
+        while(cycles > 0 ? cpu->getInstructionCount() < cycles : frame < frames) {
+            auto due = paced ? pacer.wait() : 1;
+            for(uint32_t i = 0; i < due; i++) {
+                keyboard->update();
+                if(movie) {
+                    keyboard->setState(movie->getKeys(static_cast<uint32_t>(frame)));
+                }
+                cpu->tick(display, keyboard, audio);
+                frame++;
+                if(wavFilename != nullptr) {
+                    samples.resize(samples.size() + frameSamples);
+                    audio->mix(&samples[samples.size() - frameSamples], static_cast<int>(frameSamples));
+                }
+                if(rewind) {
+                    auto before = std::chrono::steady_clock::now();
+                    rewind->record(*cpu, *display, *keyboard);
+                    recording += std::chrono::steady_clock::now() - before;
+                }
+            }
+            CHIP8_TRACE_DRAIN(stderr);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        report(argv[i], frame, cpu->getInstructionCount(),
+            std::chrono::duration<double>(end - start).count());
+        if(seeded) {
+            printf("%-40s framebuffer %016llx\n", "",
+                static_cast<unsigned long long>(hashRows(*display)));
+        }
+        if(wavFilename != nullptr && Chip8::writeWav(wavFilename, samples, audio->getSampleRate())) {
+            printf("%-40s wrote %zu samples to %s\n", "", samples.size(), wavFilename);
+        }
+        if(rewind) {
+            auto kept = rewind->getFrames();
+            printf("%-40s rewind %zu frames in %zu bytes, %.1f bytes/frame, record %.0f ns/frame\n", "",
+                kept,
+                rewind->getUsedBytes(),
+                kept > 0 ? static_cast<double>(rewind->getUsedBytes()) / kept : 0.0,
+                frame > 0 ? std::chrono::duration<double, std::nano>(recording).count() / frame : 0.0);
+        }
+        if(paced) {
+            auto stats = pacer.getStats();
+            printf("%-40s %llu dropped, jitter mean %.1f us max %.1f us, cpu %.1f%%\n", "",
+                static_cast<unsigned long long>(stats.dropped),
+                stats.meanJitter,
+                stats.maxJitter,
+                stats.cpuUsage * 100);
+        }
+    }
+}
@@ -1,13 +1,79 @@
 #include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "chip8/emulator.h"
 #include "chip8/memory.h"
 #include "chip8/cpu.h"
 
 int main(int argc, char* argv[]) {
-    char* romFilename = argv[1];
+    int scale = Chip8::SCALE;
+    auto palette = Chip8::DEFAULT_PALETTE;
+    double speed = 1.0;
+    auto timing = Chip8::Timing::vip();
+    Chip8::Quirks quirks;
+    bool seeded = false;
+    uint32_t seed = 0;
+    char const* movie = nullptr;
+    bool invalid = false;
+    int first = 1;
+    while(first + 1 < argc && argv[first][0] == '-') {
+        if(strcmp(argv[first], "--scale") == 0) {
+            scale = atoi(argv[first + 1]);
+            first += 2;
+        } else if(strcmp(argv[first], "--speed") == 0) {
+            speed = atof(argv[first + 1]);
+            first += 2;
+        } else if(strcmp(argv[first], "--timing") == 0) {
+            invalid |= !Chip8::Timing::parse(argv[first + 1], timing);
+            first += 2;
+        } else if(strcmp(argv[first], "--quirks") == 0) {
+            invalid |= !Chip8::Quirks::parse(argv[first + 1], quirks);
+            first += 2;
+        } else if(strcmp(argv[first], "--seed") == 0) {
+            seed = strtoul(argv[first + 1], nullptr, 10);
+            seeded = true;
+            first += 2;
+        } else if(strcmp(argv[first], "--record") == 0) {
+            movie = argv[first + 1];
+            first += 2;
+        } else if(strcmp(argv[first], "--palette") == 0 && first + 2 < argc) {
+            palette.background = 0xFF000000 | strtoul(argv[first + 1], nullptr, 16);
+            palette.foreground = 0xFF000000 | strtoul(argv[first + 2], nullptr, 16);
+            first += 3;
+        } else {
+            break;
+        }
+    }
+    if(invalid || first >= argc || scale <= 0) {
+        printf("Usage: %s [--scale N] [--palette RRGGBB RRGGBB] [--speed X] [--timing vip|fast|IPS]\n"
+            "       [--quirks default|chip8|schip|xochip] [--seed N] [--record FILE] rom\n"
+            "       --speed 0 runs as fast as possible\n"
+            "       --timing sets the instructions per frame: as on the COSMAC VIP (default),\n"
+            "       a fixed number per second, or as many as the host can run\n"
+            "       --quirks picks the behaviour of instructions that differ between platforms\n"
+            "       --record writes the input to a movie that chip8_headless --replay plays back\n", argv[0]);
+        return 1;
+    }
+
+    char* romFilename = argv[first];
     auto memory = std::make_shared<Chip8::Memory>();
-    memory->loadROM(romFilename);
-    auto emulator = std::make_unique<Chip8::Emulator>(memory);
+    auto emulator = std::make_unique<Chip8::Emulator>(memory, scale, palette);
+    emulator->setSpeed(speed);
+    emulator->setTiming(timing);
+    // the quirks decide how much memory there is, so they go first
+    emulator->setQuirks(quirks);
+    auto error = memory->loadROM(romFilename);
+    if(error != Chip8::RomError::None) {
+        printf("%s %s\n", romFilename, Chip8::describe(error));
+        return 1;
+    }
+    if(seeded) {
+        emulator->setSeed(seed);
+    }
+    if(movie != nullptr) {
+        emulator->recordMovie(movie);
+    }
     emulator->run(); 
     emulator.reset();
 }
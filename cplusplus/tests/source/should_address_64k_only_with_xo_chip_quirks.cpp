@@ -0,0 +1,25 @@
+#include "tests_common.h"
+#include "../include/chip8/quirks.h"
+
+// Addresses wrap around at 4 KB until the XO-CHIP quirks give the machine
+// its whole 16 bit address space.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+
+    // act
+    memory->set(0x1234, 7);
+    auto small = memory->getSize();
+    auto wrapped = memory->get(0x0234);
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    memory->set(0xC000, 9);
+    auto large = memory->getSize();
+    auto unwrapped = memory->get(0x1234);
+
+    // assert
+    assert(small == Chip8::RAM_SIZE && wrapped == 7);
+    assert(large == Chip8::XO_RAM_SIZE && unwrapped == 0);
+    assert(memory->get(0xC000) == 9 && memory->get(0x0000) != 9);
+}
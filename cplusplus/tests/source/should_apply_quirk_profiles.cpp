@@ -0,0 +1,98 @@
+#include "tests_common.h"
+#include <cstring>
+#include "../include/chip8/batch_cpu.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/quirks.h"
+
+// 0x200: V1 = 0x81, V2 = 0x04, shift V1 right, I = 0x300, store V0-V1,
+//        jump with offset to 0x210
+//        (or 0x214 with VX)
+// 0x210: loop
+// 0x214: loop
+static uint8_t PROGRAM[] = {
+    0x61, 0x81, 0x62, 0x04, 0x81, 0x26, 0xA3, 0x00, 0xF1, 0x55, 0xB2, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x12, 0x10, 0x00, 0x00, 0x12, 0x14
+};
+
+struct Result {
+    uint8_t v1;
+    uint16_t index;
+    uint16_t pc;
+
+    bool operator==(const Result& other) const {
+        return v1 == other.v1 && index == other.index && pc == other.pc;
+    }
+};
+
+static Result step(const Chip8::Quirks& quirks) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    memory->load(512, PROGRAM, sizeof(PROGRAM));
+    cpu->setQuirks(quirks);
+    emulate(cpu, 12);
+    return { registers->get(1), cpu->getIndex(), cpu->getPc() };
+}
+
+static Result tick(const Chip8::Quirks& quirks, bool blocks, bool recompile) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    memory->load(512, PROGRAM, sizeof(PROGRAM));
+    cpu->setQuirks(quirks);
+    cpu->setBlockExecution(blocks);
+    cpu->setRecompilation(recompile);
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    auto audio = std::make_shared<Chip8::Audio>();
+    cpu->tick(display, keyboard, audio);
+    return { registers->get(1), cpu->getIndex(), cpu->getPc() };
+}
+
+// Runs the instructions every profile disagrees on, one at a time, a frame
+// at a time and in lockstep lanes.
+int main() {
+    // arrange
+    Chip8::Quirks profiles[] = {
+        Chip8::Quirks(), Chip8::Quirks::chip8(), Chip8::Quirks::superChip(), Chip8::Quirks::xoChip()
+    };
+    Result expected[] = {
+        { 0x40, 0x300, 0x210 },
+        { 0x02, 0x302, 0x210 },
+        { 0x40, 0x300, 0x214 },
+        { 0x02, 0x302, 0x210 },
+    };
+    Chip8::Quirks xoChip;
+    auto parsed = Chip8::Quirks::parse("xochip", xoChip);
+    auto unknown = Chip8::Quirks::parse("cosmac", xoChip);
+
+    for(int p = 0; p < 4; p++) {
+        // act
+        auto stepped = step(profiles[p]);
+        auto interpreted = tick(profiles[p], false, false);
+        auto blocks = tick(profiles[p], true, false);
+        auto recompiled = tick(profiles[p], true, true);
+        Chip8::BatchCPU batch(4);
+        for(size_t lane = 0; lane < batch.getSize(); lane++) {
+            batch.getMemory(lane).load(512, PROGRAM, sizeof(PROGRAM));
+        }
+        batch.setQuirks(profiles[p]);
+        batch.tick();
+
+        // assert
+        assert(stepped == expected[p]);
+        assert(interpreted == expected[p]);
+        assert(blocks == expected[p]);
+        assert(recompiled == expected[p]);
+        for(size_t lane = 0; lane < batch.getSize(); lane++) {
+            Result lockstep = { batch.getRegister(lane, 1), batch.getIndex(lane), batch.getPc(lane) };
+            assert(lockstep == expected[p]);
+        }
+        assert(Chip8::Quirks::fromMask(profiles[p].getMask()).getMask() == profiles[p].getMask());
+    }
+    assert(parsed);
+    assert(!unknown);
+    assert(xoChip.spriteEdge == Chip8::SpriteEdge::Wrap);
+}
@@ -0,0 +1,107 @@
+#include "tests_common.h"
+#include <vector>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+
+static const int FRAME_SAMPLES = Chip8::Audio::SAMPLE_RATE / 60;
+
+// Mixes a frame worth of samples, as the SDL callback would while the
+// frame runs, and counts the samples the beeper sounded in.
+static int mix(Chip8::Audio& audio, int16_t* wave = nullptr) {
+    std::vector<int16_t> samples(FRAME_SAMPLES);
+    audio.mix(samples.data(), FRAME_SAMPLES);
+    int sounding = 0;
+    for(int i = 0; i < FRAME_SAMPLES; i++) {
+        sounding += samples[i] != 0 ? 1 : 0;
+        if(wave != nullptr) {
+            wave[i] = samples[i];
+        }
+    }
+    return sounding;
+}
+
+// Runs a program that sets the sound timer to 5 and spins.
+static int tick(const std::shared_ptr<Chip8::Audio>& audio, bool recompile, int frames, bool* playing) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    uint8_t program[] = { 0x60, 0x05, 0xF0, 0x18, 0x12, 0x04 };
+    memory->load(512, program, sizeof(program));
+    cpu->setRecompilation(recompile);
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    int sounding = 0;
+    for(int frame = 0; frame < frames; frame++) {
+        cpu->tick(display, keyboard, audio);
+        playing[frame] = audio != nullptr && audio->isPlaying();
+        sounding += audio != nullptr ? mix(*audio) : 0;
+    }
+    return sounding;
+}
+
+// Switches the beeper through the event ring and checks that the wave
+// lasts as long in samples as it did in guest time.
+int main() {
+    // arrange
+    Chip8::Audio direct;
+    int16_t wave[FRAME_SAMPLES];
+
+    // act
+    int directSounding = 0;
+    for(int frame = 1; frame < 8; frame++) {
+        direct.beginFrame();
+        if(frame == 1) {
+            direct.play(0.5f);
+        }
+        if(frame == 4) {
+            direct.pause();
+        }
+        directSounding += mix(direct, frame == 2 ? wave : nullptr);
+    }
+
+    // assert
+    // from half way through frame 1 to the start of frame 4
+    assert(directSounding == 4 * FRAME_SAMPLES - (FRAME_SAMPLES + FRAME_SAMPLES / 2));
+    // the wave starts half way through the second frame
+    assert(wave[FRAME_SAMPLES / 2 - 1] == 0);
+    assert(wave[FRAME_SAMPLES / 2 + 10] == Chip8::Audio::AMPLITUDE);
+    assert(wave[FRAME_SAMPLES / 2 + 60] == -Chip8::Audio::AMPLITUDE);
+
+    for(int mode = 0; mode < 2; mode++) {
+        // arrange
+        auto audio = std::make_shared<Chip8::Audio>();
+        bool playing[8];
+
+        // act
+        auto sounding = tick(audio, mode == 1, 8, playing);
+
+        // assert
+        // FX18 runs early in frame 0 and the timer reaches 0 at frame 5
+        for(int frame = 0; frame < 8; frame++) {
+            assert(playing[frame] == (frame < 5));
+        }
+        assert(sounding > 5 * FRAME_SAMPLES - FRAME_SAMPLES / 100);
+        assert(sounding < 5 * FRAME_SAMPLES);
+    }
+
+    // act
+    bool silent[8];
+    auto withoutAudio = tick(nullptr, false, 8, silent);
+
+    // assert
+    assert(withoutAudio == 0);
+
+    // arrange
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    auto initialized = SDL_InitSubSystem(SDL_INIT_AUDIO) == 0;
+    Chip8::Audio device;
+
+    // act
+    auto opened = initialized && device.open();
+    device.close();
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+    // assert
+    assert(opened);
+}
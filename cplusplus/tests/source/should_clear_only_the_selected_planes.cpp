@@ -0,0 +1,19 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+
+// Draws to both planes, then clears with only the second one selected.
+int main() {
+    // arrange
+    Chip8::Display display;
+    uint8_t sprite[] = { 0xFF, 0xFF };
+    display.selectPlanes(3);
+    display.drawSprite(0, 0, sprite, 1, Chip8::SpriteEdge::Clip);
+
+    // act
+    display.selectPlanes(2);
+    display.clear();
+
+    // assert
+    assert(display.getPlane(0)[0] == 0xFF00000000000000);
+    assert(display.getPlane(1)[0] == 0);
+}
@@ -0,0 +1,24 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/renderer.h"
+
+// Pixels set in the first plane, both planes, the second plane or neither
+// take the four colors of the palette.
+int main() {
+    // arrange
+    Chip8::Display display;
+    uint8_t sprite[] = { 0xF0, 0x3C };
+    display.selectPlanes(3);
+    display.drawSprite(8, 4, sprite, 1, Chip8::SpriteEdge::Clip);
+    Chip8::Renderer renderer;
+    Chip8::Palette palette = Chip8::DEFAULT_PALETTE;
+
+    // act
+    renderer.present(display.getPlanes());
+
+    // assert
+    assert(renderer.getPixels()[4 * 64 + 8] == palette.foreground);
+    assert(renderer.getPixels()[4 * 64 + 10] == palette.bothPlanes);
+    assert(renderer.getPixels()[4 * 64 + 12] == palette.secondPlane);
+    assert(renderer.getPixels()[4 * 64 + 14] == palette.background);
+}
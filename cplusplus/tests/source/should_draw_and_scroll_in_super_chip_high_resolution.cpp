@@ -0,0 +1,111 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/renderer.h"
+#include "../include/chip8/snapshot.h"
+#include "../include/chip8/snapshot_store.h"
+
+static void run(std::shared_ptr<Chip8::CPU> cpu, std::shared_ptr<Chip8::Display> display, int instructions) {
+    for(int i = 0; i < instructions; i++) {
+        cpu->emulateCycle(display, nullptr);
+    }
+}
+
+// Switches to high resolution and draws a solid 16x16 sprite across the
+// middle of the rows, then scrolls it around.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    auto display = std::make_shared<Chip8::Display>();
+    Chip8::Keyboard keyboard;
+    uint8_t program[] = {
+        0x00, 0xFF,             // hires
+        0x60, 0x3C, 0x61, 0x02, // V0 = 60, V1 = 2
+        0xA3, 0x00, 0xD0, 0x10, // 16x16 sprite at 60, 2
+        0x00, 0xFB,             // scroll right
+        0x00, 0xFC, 0x00, 0xFC, // scroll left twice
+        0x00, 0xC3,             // scroll down 3
+        0x62, 0x0A, 0xF2, 0x30, // I = large A
+        0x00, 0xFE              // lores
+    };
+    memory->load(0x200, program, sizeof(program));
+    for(int i = 0; i < 32; i++) {
+        memory->set(0x300 + i, 0xFF);
+    }
+
+    // act
+    run(cpu, display, 1);
+    auto hires = display->isHires();
+    auto width = display->getWidth();
+    run(cpu, display, 4);
+    auto drawnLeft = display->getRows()[2 * 2];
+    auto drawnRight = display->getRows()[2 * 2 + 1];
+    run(cpu, display, 1);
+    auto rightLeft = display->getRows()[2 * 2];
+    auto rightRight = display->getRows()[2 * 2 + 1];
+    run(cpu, display, 2);
+    auto leftLeft = display->getRows()[2 * 2];
+    auto leftRight = display->getRows()[2 * 2 + 1];
+    run(cpu, display, 1);
+    Chip8::Snapshot snapshot;
+    snapshot.save(*cpu, *display, keyboard);
+    Chip8::SnapshotStore store;
+    auto stored = store.save(*cpu, *display, keyboard);
+    Chip8::Renderer renderer;
+    renderer.present(display->getPlanes(), display->isHires());
+    run(cpu, display, 2);
+    auto largeA = cpu->getIndex();
+    run(cpu, display, 1);
+    auto lowres = !display->isHires() && display->getWidth() == 64 && display->getRows()[5 * 2] == 0;
+    auto restored = snapshot.restore(*cpu, *display, keyboard);
+    auto restoredRows = display->getRows()[5 * 2 + 1];
+    display->setHires(false);
+    display->clear();
+    store.restore(stored, *cpu, *display, keyboard);
+    auto storedRestored = display->isHires() && display->getRows()[20 * 2 + 1] == 0xFF00000000000000;
+
+    Chip8::Display wrapping;
+    Chip8::Display clipping;
+    wrapping.setHires(true);
+    clipping.setHires(true);
+    uint8_t block[32];
+    for(auto& byte : block) {
+        byte = 0xFF;
+    }
+    auto firstCollision = wrapping.drawLargeSprite(124, 62, block, Chip8::SpriteEdge::Wrap);
+    clipping.drawLargeSprite(124, 62, block, Chip8::SpriteEdge::Clip);
+    uint64_t wrapped[Chip8::FRAME_WORDS];
+    for(int i = 0; i < Chip8::FRAME_WORDS; i++) {
+        wrapped[i] = wrapping.getRows()[i];
+    }
+    auto secondCollision = wrapping.drawLargeSprite(124, 62, block, Chip8::SpriteEdge::Wrap);
+
+    // assert
+    assert(hires && width == 128);
+    assert(drawnLeft == 0xF && drawnRight == 0xFFF0000000000000);
+    assert(0 == registers->get(0xF));
+    assert(rightLeft == 0 && rightRight == 0xFFFF000000000000);
+    assert(leftLeft == 0xFF && leftRight == 0xFF00000000000000);
+    assert(display->getRows()[4 * 2] == 0 && display->getRows()[5 * 2] == 0xFF);
+    assert(display->getRows()[20 * 2 + 1] == 0xFF00000000000000 && display->getRows()[21 * 2 + 1] == 0);
+    assert(display->getPixel(56, 5) && !display->getPixel(55, 5) && display->getPixel(71, 20) && !display->getPixel(72, 20));
+    assert(Chip8::LARGE_SPRITE_CHARS_ADDR + 100 == largeA);
+    assert(0x18 == memory->get(largeA) && 0xC3 == memory->get(largeA + 9));
+    assert(lowres);
+    assert(restored && display->isHires() && restoredRows == 0xFF00000000000000);
+    assert(Chip8::SnapshotStore::FRAME_PAGES == 8);
+
+    assert(0xFFFFFFFF == renderer.getPixels()[5 * 128 + 56]);
+    assert(0xFF000000 == renderer.getPixels()[5 * 128 + 55]);
+    assert(128 == renderer.getWidth());
+
+    assert(storedRestored);
+    assert(!firstCollision && secondCollision);
+    assert(wrapped[62 * 2] == 0xFFF0000000000000 && wrapped[62 * 2 + 1] == 0xF);
+    assert(wrapped[13 * 2] == 0xFFF0000000000000 && wrapped[13 * 2 + 1] == 0xF);
+    assert(wrapped[14 * 2] == 0 && wrapped[61 * 2 + 1] == 0);
+    assert(clipping.getRows()[62 * 2] == 0 && clipping.getRows()[63 * 2 + 1] == 0xF);
+    assert(clipping.getRows()[0] == 0 && clipping.getRows()[1] == 0);
+}
@@ -0,0 +1,32 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/quirks.h"
+
+// Selects both planes and draws a 5 row sprite from above 4 KB, which
+// takes 5 bytes for the first plane followed by 5 for the second.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    auto display = std::make_shared<Chip8::Display>();
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    // I = 0x8000, select planes 1 and 2, V0 = 8, V1 = 4, draw 5 rows at 8, 4
+    uint8_t program[] = { 0xF0, 0x00, 0x80, 0x00, 0xF3, 0x01, 0x60, 0x08, 0x61, 0x04, 0xD0, 0x15 };
+    memory->load(0x200, program, sizeof(program));
+    for(int i = 0; i < 5; i++) {
+        memory->set(0x8000 + i, 0xF0);
+        memory->set(0x8005 + i, 0x3C);
+    }
+
+    // act
+    for(int i = 0; i < 5; i++) {
+        cpu->emulateCycle(display, nullptr);
+    }
+
+    // assert
+    assert(display->getSelectedPlanes() == 3);
+    assert(display->getPlane(0)[4] == 0x00F0000000000000 && display->getPlane(1)[4] == 0x003C000000000000);
+    assert(display->getPlane(0)[8] == 0x00F0000000000000 && display->getPlane(1)[8] == 0x003C000000000000);
+    assert(display->getPlane(0)[9] == 0 && display->getPlane(1)[9] == 0);
+}
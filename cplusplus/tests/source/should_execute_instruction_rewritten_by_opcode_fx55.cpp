@@ -0,0 +1,17 @@
+#include "tests_common.h"
+
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    uint8_t data[] = { 0x62, 0x05, 0x60, 0x62, 0x61, 0x07, 0xA2, 0x00, 0xF1, 0x55, 0x12, 0x00 };
+    memory->load(512, data, sizeof(data));
+
+    // act: run the program, then the rewritten first instruction once more
+    emulate(cpu, sizeof(data) + 2);
+
+    // assert
+    assert(7 == registers->get(2));
+    assert(514 == cpu->getPc());
+}
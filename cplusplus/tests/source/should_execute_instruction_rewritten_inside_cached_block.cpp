@@ -0,0 +1,30 @@
+#include "tests_common.h"
+
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    uint8_t data[] = {
+        0x12, 0x02, // 0x200: jump to 0x202
+        0x72, 0x01, // 0x202: V2 += 1, rewritten to V2 += 0x10
+        0x33, 0x01, // 0x204: skip if V3 == 1
+        0x12, 0x10, // 0x206: jump to 0x210
+        0x12, 0x08, // 0x208: loop forever
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x60, 0x72, // 0x210: V0 = 0x72
+        0x61, 0x10, // 0x212: V1 = 0x10
+        0xA2, 0x02, // 0x214: I = 0x202
+        0xF1, 0x55, // 0x216: store V0, V1 at 0x202
+        0x63, 0x01, // 0x218: V3 = 1
+        0x12, 0x02  // 0x21A: jump to 0x202
+    };
+    memory->load(512, data, sizeof(data));
+
+    // act
+    cpu->tick(nullptr, nullptr, nullptr);
+
+    // assert
+    assert(0x11 == registers->get(2));
+    assert(0x208 == cpu->getPc() || 0x20A == cpu->getPc());
+}
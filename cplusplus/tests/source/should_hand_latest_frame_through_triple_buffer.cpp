@@ -0,0 +1,43 @@
+#include "tests_common.h"
+#include <thread>
+#include "../include/chip8/triple_buffer.h"
+
+struct Frame {
+    uint64_t rows[32];
+};
+
+// A producer publishes frames whose rows all hold the frame number while
+// the consumer checks that it never sees a torn or an older frame.
+int main() {
+    // arrange
+    const uint64_t frames = 200000;
+    Chip8::TripleBuffer<Frame> buffer;
+
+    // act
+    std::thread producer([&] {
+        for(uint64_t number = 1; number <= frames; number++) {
+            auto& frame = buffer.back();
+            for(auto& row : frame.rows) {
+                row = number;
+            }
+            buffer.publish();
+        }
+    });
+
+    // assert
+    uint64_t last = 0;
+    while(last < frames) {
+        if(!buffer.update()) {
+            std::this_thread::yield();
+            continue;
+        }
+        auto& frame = buffer.front();
+        assert(frame.rows[0] > last);
+        for(auto row : frame.rows) {
+            assert(row == frame.rows[0]);
+        }
+        last = frame.rows[0];
+    }
+    producer.join();
+    assert(!buffer.update());
+}
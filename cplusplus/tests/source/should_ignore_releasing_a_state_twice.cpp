@@ -0,0 +1,38 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/snapshot_store.h"
+
+// Releases a fork twice. The second release must not free the pages the
+// fork shares with its parent, which a later save would then overwrite,
+// and the released id can no longer be forked or restored.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, std::make_shared<Chip8::Registers>());
+    Chip8::Display display;
+    Chip8::Keyboard keyboard;
+    memory->set(0x300, 0x42);
+    Chip8::SnapshotStore store;
+    auto root = store.save(*cpu, display, keyboard);
+    auto child = store.fork(root);
+
+    // act
+    auto first = store.release(child);
+    auto second = store.release(child);
+    auto forked = store.fork(child);
+    auto restoredChild = store.restore(child, *cpu, display, keyboard);
+    auto pages = store.getUsage().pages;
+    memory->set(0x300, 0x43);
+    auto other = store.save(*cpu, display, keyboard);
+    auto otherPages = store.getUsage().pages;
+    memory->set(0x300, 0);
+    auto restoredRoot = store.restore(root, *cpu, display, keyboard);
+
+    // assert
+    assert(first && !second);
+    assert(forked == Chip8::SnapshotStore::NONE && !restoredChild);
+    assert(pages == Chip8::SnapshotStore::PAGES);
+    assert(other != Chip8::SnapshotStore::NONE && otherPages == 2 * Chip8::SnapshotStore::PAGES);
+    assert(restoredRoot && memory->get(0x300) == 0x42);
+}
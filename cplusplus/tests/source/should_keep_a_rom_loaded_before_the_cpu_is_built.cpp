@@ -0,0 +1,21 @@
+#include "tests_common.h"
+#include <vector>
+
+// Loads an XO-CHIP program larger than 4 KB, then builds the CPU on that
+// memory. Nothing above 4 KB may be lost.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    memory->setSize(Chip8::XO_RAM_SIZE);
+    std::vector<uint8_t> program(0x1F01 - Chip8::PROGRAM_START_ADDRESS, 0x00);
+    program.back() = 0xAB;
+    memory->loadROM(program.data(), program.size());
+
+    // act
+    auto cpu = std::make_shared<Chip8::CPU>(memory, std::make_shared<Chip8::Registers>());
+
+    // assert
+    assert(memory->getSize() == Chip8::XO_RAM_SIZE);
+    assert(cpu->getQuirks().memorySize == Chip8::XO_RAM_SIZE);
+    assert(memory->get(0x1F00) == 0xAB);
+}
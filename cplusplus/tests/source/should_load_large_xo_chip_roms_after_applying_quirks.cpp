@@ -0,0 +1,26 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "../include/chip8/quirks.h"
+
+// Loads a ROM larger than 4 KB from a file the way the frontends do: the
+// CPU is built and given the XO-CHIP quirks, then the file is loaded.
+int main() {
+    // arrange
+    auto path = std::filesystem::temp_directory_path() / "chip8_large_rom_test.ch8";
+    std::vector<char> program(0x1F01 - Chip8::PROGRAM_START_ADDRESS, 0);
+    program.back() = static_cast<char>(0xAB);
+    std::ofstream(path, std::ios::binary).write(program.data(), program.size());
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, std::make_shared<Chip8::Registers>());
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+
+    // act
+    auto loaded = memory->loadROM(path.c_str());
+    std::filesystem::remove(path);
+
+    // assert
+    assert(loaded == Chip8::RomError::None);
+    assert(memory->get(0x1F00) == 0xAB);
+}
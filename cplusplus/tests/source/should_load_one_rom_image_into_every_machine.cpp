@@ -0,0 +1,41 @@
+#include "tests_common.h"
+#include <vector>
+#include "../include/chip8/batch_cpu.h"
+#include "../include/chip8/emulator_pool.h"
+#include "../include/chip8/rom.h"
+
+static bool matches(Chip8::Memory& memory, const Chip8::Rom& rom) {
+    for(size_t i = 0; i < rom.size(); i++) {
+        if(memory.get(static_cast<uint16_t>(Chip8::PROGRAM_START_ADDRESS + i)) != rom.data()[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Loads one mapped ROM into every machine of a pool and every lane of a
+// batch, and the file straight into a single machine.
+int main() {
+    // arrange
+    Chip8::Rom rom;
+    rom.open(CHIP8_ROMS_DIR "/BRIX.ch8");
+    Chip8::Memory memory;
+    Chip8::EmulatorPool pool(5, 1);
+    Chip8::BatchCPU batch(3);
+
+    // act
+    auto loaded = memory.loadROM(CHIP8_ROMS_DIR "/BRIX.ch8");
+    auto pooled = pool.loadROM(rom.data(), rom.size());
+    auto batched = batch.loadROM(rom.data(), rom.size());
+
+    // assert
+    assert(loaded == Chip8::RomError::None && matches(memory, rom));
+    assert(pooled == Chip8::RomError::None);
+    for(size_t m = 0; m < pool.getSize(); m++) {
+        assert(matches(*pool.getMachine(m).memory, rom));
+    }
+    assert(batched == Chip8::RomError::None);
+    for(size_t lane = 0; lane < batch.getSize(); lane++) {
+        assert(matches(batch.getMemory(lane), rom));
+    }
+}
@@ -0,0 +1,25 @@
+#include "tests_common.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "../include/chip8/rom.h"
+
+// Maps a ROM file and compares it with the bytes read from it, then closes
+// it again.
+int main() {
+    // arrange
+    std::ifstream file(CHIP8_ROMS_DIR "/BRIX.ch8", std::ios::binary);
+    std::vector<uint8_t> brix(std::istreambuf_iterator<char>(file), {});
+    Chip8::Rom rom;
+
+    // act
+    auto opened = rom.open(CHIP8_ROMS_DIR "/BRIX.ch8");
+    auto mapped = rom.size() == brix.size() && std::equal(brix.begin(), brix.end(), rom.data());
+    rom.close();
+
+    // assert
+    assert(!brix.empty());
+    assert(opened == Chip8::RomError::None && mapped);
+    assert(rom.data() == nullptr && rom.size() == 0);
+}
@@ -0,0 +1,51 @@
+#include "tests_common.h"
+#include <filesystem>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+
+// Runs every bundled ROM on an interpreting and a recompiling CPU in
+// lockstep and compares their state after every frame.
+int main() {
+    for(auto& entry : std::filesystem::recursive_directory_iterator(CHIP8_ROMS_DIR)) {
+        if(entry.path().extension() != ".ch8") {
+            continue;
+        }
+
+        // arrange
+        auto memory = std::make_shared<Chip8::Memory>();
+        auto registers = std::make_shared<Chip8::Registers>();
+        auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+        auto jitMemory = std::make_shared<Chip8::Memory>();
+        auto jitRegisters = std::make_shared<Chip8::Registers>();
+        auto jitCpu = std::make_shared<Chip8::CPU>(jitMemory, jitRegisters);
+        memory->loadROM(entry.path().c_str());
+        jitMemory->loadROM(entry.path().c_str());
+        cpu->seedRandom(1);
+        jitCpu->seedRandom(1);
+        jitCpu->setRecompilation(true);
+        auto display = std::make_shared<Chip8::Display>();
+        auto jitDisplay = std::make_shared<Chip8::Display>();
+        auto keyboard = std::make_shared<Chip8::Keyboard>();
+        auto audio = std::make_shared<Chip8::Audio>();
+
+        for(int frame = 0; frame < 120; frame++) {
+            // act
+            cpu->tick(display, keyboard, audio);
+            jitCpu->tick(jitDisplay, keyboard, audio);
+
+            // assert
+            assert(cpu->getPc() == jitCpu->getPc());
+            assert(cpu->getIndex() == jitCpu->getIndex());
+            assert(cpu->getDelayTimer() == jitCpu->getDelayTimer());
+            assert(cpu->getSoundTimer() == jitCpu->getSoundTimer());
+            assert(cpu->getInstructionCount() == jitCpu->getInstructionCount());
+            for(uint8_t i = 0; i < 16; i++) {
+                assert(registers->get(i) == jitRegisters->get(i));
+            }
+            for(int row = 0; row < 32; row++) {
+                assert(display->getRows()[row] == jitDisplay->getRows()[row]);
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <vector>
+#include "../include/chip8/batch_cpu.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+
+// Runs every bundled ROM on the lanes of a BatchCPU and on one scalar CPU
+// per lane, and compares their state after every frame. Each lane gets its
+// own random seed and keys, so the lanes drift apart over time.
+int main() {
+    const size_t lanes = 5;
+    for(auto& entry : std::filesystem::recursive_directory_iterator(CHIP8_ROMS_DIR)) {
+        if(entry.path().extension() != ".ch8") {
+            continue;
+        }
+
+        // arrange
+        Chip8::BatchCPU batch(lanes);
+        batch.loadROM(entry.path().c_str());
+        std::vector<std::shared_ptr<Chip8::Registers>> registers;
+        std::vector<std::shared_ptr<Chip8::CPU>> cpus;
+        std::vector<std::shared_ptr<Chip8::Display>> displays;
+        std::vector<std::shared_ptr<Chip8::Keyboard>> keyboards;
+        auto audio = std::make_shared<Chip8::Audio>();
+        for(size_t lane = 0; lane < lanes; lane++) {
+            auto memory = std::make_shared<Chip8::Memory>();
+            memory->loadROM(entry.path().c_str());
+            registers.push_back(std::make_shared<Chip8::Registers>());
+            cpus.push_back(std::make_shared<Chip8::CPU>(memory, registers[lane]));
+            displays.push_back(std::make_shared<Chip8::Display>());
+            keyboards.push_back(std::make_shared<Chip8::Keyboard>());
+            cpus[lane]->seedRandom(lane);
+            batch.seedRandom(lane, lane);
+        }
+
+        for(int frame = 0; frame < 120; frame++) {
+            // act
+            for(size_t lane = 0; lane < lanes; lane++) {
+                auto key = (frame / 8 + lane) & 0xF;
+                keyboards[lane]->setKey(key, frame % 8 < 4);
+                batch.getKeyboard(lane).setKey(key, frame % 8 < 4);
+                keyboards[lane]->update();
+                cpus[lane]->tick(displays[lane], keyboards[lane], audio);
+            }
+            batch.tick();
+
+            // assert
+            for(size_t lane = 0; lane < lanes; lane++) {
+                assert(batch.getPc(lane) == cpus[lane]->getPc());
+                assert(batch.getIndex(lane) == cpus[lane]->getIndex());
+                assert(batch.getDelayTimer(lane) == cpus[lane]->getDelayTimer());
+                assert(batch.getSoundTimer(lane) == cpus[lane]->getSoundTimer());
+                assert(batch.getInstructionCount(lane) == cpus[lane]->getInstructionCount());
+                for(uint8_t i = 0; i < 16; i++) {
+                    assert(batch.getRegister(lane, i) == registers[lane]->get(i));
+                }
+                for(int row = 0; row < 32; row++) {
+                    assert(batch.getDisplay(lane).getRows()[row] == displays[lane]->getRows()[row]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/quirks.h"
+#include "../include/chip8/snapshot_store.h"
+
+// Restoring a stored XO-CHIP state into a 4 KB machine fails and leaves
+// that machine alone, and memory refuses ranges past its end.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, std::make_shared<Chip8::Registers>());
+    auto smallMemory = std::make_shared<Chip8::Memory>();
+    auto smallCpu = std::make_shared<Chip8::CPU>(smallMemory, std::make_shared<Chip8::Registers>());
+    Chip8::Display display;
+    Chip8::Keyboard keyboard;
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    memory->set(0x0300, 0x42);
+    Chip8::SnapshotStore store;
+    auto stored = store.save(*cpu, display, keyboard);
+    uint8_t page[Chip8::SnapshotStore::PAGE_SIZE];
+    for(auto& byte : page) {
+        byte = 0xEE;
+    }
+
+    // act
+    auto restored = store.restore(stored, *smallCpu, display, keyboard);
+    auto restoredPastEnd = smallMemory->restore(Chip8::RAM_SIZE - 16, page, sizeof(page));
+
+    // assert
+    assert(!restored);
+    assert(smallMemory->get(0x0300) == 0);
+    assert(!restoredPastEnd);
+    assert(smallMemory->get(Chip8::RAM_SIZE - 16) == 0 && smallMemory->get(0) == 0xF0);
+}
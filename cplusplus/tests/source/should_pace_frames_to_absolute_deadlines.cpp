@@ -0,0 +1,31 @@
+#include "tests_common.h"
+#include <chrono>
+#include <thread>
+#include "../include/chip8/frame_pacer.h"
+
+int main() {
+    // arrange
+    Chip8::FramePacer pacer(200);
+    auto start = std::chrono::steady_clock::now();
+
+    // act
+    uint64_t frames = 0;
+    while(frames < 20) {
+        frames += pacer.wait();
+    }
+    auto paced = std::chrono::steady_clock::now() - start;
+    // stall for 10 frames
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto caughtUp = pacer.wait();
+    auto stats = pacer.getStats();
+
+    // assert
+    // frame 0 runs at once, frame 19 is due after 95 ms
+    assert(paced >= std::chrono::milliseconds(95));
+    assert(paced < std::chrono::milliseconds(1000));
+    assert(Chip8::FramePacer::MAX_CATCH_UP == caughtUp);
+    assert(stats.dropped >= 5);
+    assert(stats.frames == frames + caughtUp);
+    assert(stats.maxJitter >= stats.meanJitter);
+    assert(stats.cpuUsage >= 0.0 && stats.cpuUsage < 1.0);
+}
@@ -0,0 +1,95 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+
+static const int FRAME_SAMPLES = Chip8::Audio::SAMPLE_RATE / 60;
+
+// Runs a program that loads a pattern of 4 high and 4 low bits, sets the
+// pitch and sounds for 10 frames, and mixes every frame after it ran.
+static std::vector<int16_t> record(uint8_t pitch, int frames) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    uint8_t program[] = {
+        0xA2, 0x20, 0xF0, 0x02, 0x60, pitch, 0xF0, 0x3A, 0x60, 0x0A, 0xF0, 0x18, 0x12, 0x0C
+    };
+    memory->load(0x200, program, sizeof(program));
+    for(int i = 0; i < Chip8::PATTERN_SIZE; i++) {
+        memory->set(0x220 + i, 0xF0);
+    }
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    auto audio = std::make_shared<Chip8::Audio>();
+    std::vector<int16_t> samples(frames * FRAME_SAMPLES);
+    for(int frame = 0; frame < frames; frame++) {
+        cpu->tick(display, keyboard, audio);
+        audio->mix(&samples[frame * FRAME_SAMPLES], FRAME_SAMPLES);
+    }
+    return samples;
+}
+
+// Level of the pattern at a sample, counted from the start of the sound.
+static int16_t expected(int sample, double bitsPerSecond) {
+    auto bit = static_cast<int>(sample * bitsPerSecond / Chip8::Audio::SAMPLE_RATE);
+    return bit % 8 < 4 ? Chip8::Audio::AMPLITUDE : -Chip8::Audio::AMPLITUDE;
+}
+
+static std::vector<uint8_t> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Plays a pattern at two pitches and checks the resampled waves, then
+// writes one of them as a WAV file twice and compares the bytes.
+int main() {
+    auto path = std::filesystem::temp_directory_path() / "chip8_audio_test.wav";
+
+    // act
+    auto normal = record(64, 14);
+    auto octave = record(64 + 48, 14);
+    auto written = Chip8::writeWav(path.c_str(), normal, Chip8::Audio::SAMPLE_RATE);
+    auto file = readFile(path);
+    Chip8::writeWav(path.c_str(), record(64, 14), Chip8::Audio::SAMPLE_RATE);
+    auto again = readFile(path);
+    std::filesystem::remove(path);
+
+    // assert
+    // FX18 runs early in the first frame, which is heard a frame later,
+    // and the sound timer runs out 10 frames after that
+    int start = 0;
+    while(start < static_cast<int>(normal.size()) && normal[start] == 0) {
+        start++;
+    }
+    assert(start > FRAME_SAMPLES && start < 2 * FRAME_SAMPLES);
+    assert(octave[start - 1] == 0 && octave[start] != 0);
+    for(int i = 0; i < 11 * FRAME_SAMPLES - start; i++) {
+        // away from the edges between bits, where rounding may differ
+        auto bit = i * 4000.0 / Chip8::Audio::SAMPLE_RATE;
+        if(bit - static_cast<int>(bit) > 0.05 && bit - static_cast<int>(bit) < 0.95) {
+            assert(normal[start + i] == expected(i, 4000.0));
+        }
+        bit *= 2;
+        if(bit - static_cast<int>(bit) > 0.05 && bit - static_cast<int>(bit) < 0.95) {
+            assert(octave[start + i] == expected(i, 8000.0));
+        }
+    }
+    assert(normal[11 * FRAME_SAMPLES - 1] != 0 && normal[11 * FRAME_SAMPLES] == 0);
+
+    assert(written);
+    assert(file.size() == 44 + normal.size() * 2);
+    const uint8_t header[] = {
+        'R', 'I', 'F', 'F', 0x88, 0x50, 0x00, 0x00, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ',
+        0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x44, 0xAC, 0x00, 0x00, 0x88, 0x58, 0x01, 0x00,
+        0x02, 0x00, 0x10, 0x00, 'd', 'a', 't', 'a', 0x64, 0x50, 0x00, 0x00
+    };
+    assert(std::equal(header, header + sizeof(header), file.begin()));
+    for(size_t i = 0; i < normal.size(); i++) {
+        assert(static_cast<int16_t>(file[44 + i * 2] | file[45 + i * 2] << 8) == normal[i]);
+    }
+    assert(file == again);
+}
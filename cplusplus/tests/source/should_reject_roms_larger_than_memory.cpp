@@ -0,0 +1,37 @@
+#include "tests_common.h"
+#include <vector>
+#include "../include/chip8/batch_cpu.h"
+#include "../include/chip8/emulator_pool.h"
+#include "../include/chip8/quirks.h"
+
+// A program fits if it ends at the last byte of memory. One byte more is
+// rejected without touching memory, unless the machine has XO-CHIP's
+// 64 KB.
+int main() {
+    // arrange
+    std::vector<uint8_t> full(Chip8::RAM_SIZE - Chip8::PROGRAM_START_ADDRESS, 0xA5);
+    std::vector<uint8_t> large(full.size() + 1, 0x5A);
+    std::vector<uint8_t> huge(Chip8::XO_RAM_SIZE - Chip8::PROGRAM_START_ADDRESS + 1, 0x5A);
+    Chip8::Memory small;
+    Chip8::Memory xo;
+    xo.setSize(Chip8::Quirks::xoChip().memorySize);
+    Chip8::EmulatorPool pool(2, 1);
+    Chip8::BatchCPU batch(2);
+
+    // act
+    auto loadedFull = small.loadROM(full.data(), full.size());
+    auto loadedLarge = small.loadROM(large.data(), large.size());
+    auto loadedLargeXo = xo.loadROM(large.data(), large.size());
+    auto loadedHuge = xo.loadROM(huge.data(), huge.size());
+    auto pooledLarge = pool.loadROM(large.data(), large.size());
+    auto batchedLarge = batch.loadROM(large.data(), large.size());
+
+    // assert
+    assert(loadedFull == Chip8::RomError::None);
+    assert(loadedLarge == Chip8::RomError::TooLarge);
+    assert(small.get(Chip8::PROGRAM_START_ADDRESS) == 0xA5 && small.get(Chip8::RAM_SIZE - 1) == 0xA5);
+    assert(loadedLargeXo == Chip8::RomError::None && xo.get(Chip8::RAM_SIZE) == 0x5A);
+    assert(loadedHuge == Chip8::RomError::TooLarge);
+    assert(pooledLarge == Chip8::RomError::TooLarge);
+    assert(batchedLarge == Chip8::RomError::TooLarge);
+}
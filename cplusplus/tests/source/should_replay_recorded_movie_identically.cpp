@@ -0,0 +1,83 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <vector>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/movie.h"
+
+// Records a run of a game with changing input, a fixed instruction rate and
+// the XO-CHIP quirks into a movie, writes it to a file and reads it back,
+// then replays it on a new machine set up from the movie and compares the
+// framebuffers of every frame.
+int main() {
+    auto path = std::filesystem::temp_directory_path() / "chip8_movie_test.c8mv";
+
+    // arrange
+    Chip8::Movie movie(1234, Chip8::Timing::fixed(1000), Chip8::Quirks::xoChip());
+    std::vector<std::vector<uint64_t>> recorded;
+    {
+        auto memory = std::make_shared<Chip8::Memory>();
+        auto registers = std::make_shared<Chip8::Registers>();
+        auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+        cpu->setTiming(movie.getTiming());
+        cpu->setQuirks(movie.getQuirks());
+        memory->loadROM(CHIP8_ROMS_DIR "/BRIX.ch8");
+        cpu->seedRandom(movie.getSeed());
+        auto display = std::make_shared<Chip8::Display>();
+        auto keyboard = std::make_shared<Chip8::Keyboard>();
+        auto audio = std::make_shared<Chip8::Audio>();
+        for(uint32_t frame = 0; frame < 600; frame++) {
+            keyboard->update();
+            // hold left and right for a while each, with a gap in between
+            if(frame % 40 == 0) {
+                keyboard->handleKeyDown(frame % 80 == 0 ? SDLK_q : SDLK_e);
+            }
+            if(frame % 40 == 30) {
+                keyboard->handleKeyUp(SDLK_q);
+                keyboard->handleKeyUp(SDLK_e);
+            }
+            movie.record(frame, keyboard->getState());
+            cpu->tick(display, keyboard, audio);
+            recorded.emplace_back(display->getRows(), display->getRows() + 32);
+        }
+    }
+    auto written = movie.write(path.c_str());
+    Chip8::Movie replay;
+    auto read = replay.read(path.c_str());
+    std::filesystem::remove(path);
+
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    cpu->setTiming(replay.getTiming());
+    cpu->setQuirks(replay.getQuirks());
+    memory->loadROM(CHIP8_ROMS_DIR "/BRIX.ch8");
+    cpu->seedRandom(replay.getSeed());
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    auto audio = std::make_shared<Chip8::Audio>();
+
+    // act
+    std::vector<std::vector<uint64_t>> replayed;
+    for(uint32_t frame = 0; frame < replay.getFrames(); frame++) {
+        keyboard->update();
+        keyboard->setState(replay.getKeys(frame));
+        cpu->tick(display, keyboard, audio);
+        replayed.emplace_back(display->getRows(), display->getRows() + 32);
+    }
+
+    // assert
+    assert(written);
+    assert(read);
+    assert(replay.getSeed() == 1234);
+    assert(replay.getTiming() == Chip8::Timing::fixed(1000));
+    assert(replay.getQuirks() == Chip8::Quirks::xoChip());
+    assert(replay.getQuirks().memorySize == Chip8::XO_RAM_SIZE);
+    assert(replay.getFrames() == 600);
+    assert(replay.getKeys(0) == 1 << 0x4);
+    assert(replay.getKeys(30) == 0);
+    assert(replay.getKeys(45) == 1 << 0x6);
+    assert(replayed == recorded);
+    assert(recorded.front() != recorded.back());
+}
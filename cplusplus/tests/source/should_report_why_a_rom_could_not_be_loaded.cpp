@@ -0,0 +1,32 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <fstream>
+#include "../include/chip8/emulator_pool.h"
+#include "../include/chip8/rom.h"
+
+// Missing files, empty files and directories each fail with their own
+// error and leave memory as it was.
+int main() {
+    // arrange
+    auto empty = std::filesystem::temp_directory_path() / "chip8_empty_rom_test.ch8";
+    std::ofstream(empty).close();
+    Chip8::Memory memory;
+    Chip8::EmulatorPool pool(2, 1);
+    Chip8::Rom rom;
+
+    // act
+    auto missing = memory.loadROM(CHIP8_ROMS_DIR "/MISSING.ch8");
+    auto emptyFile = memory.loadROM(empty.c_str());
+    auto directory = memory.loadROM(CHIP8_ROMS_DIR);
+    auto openedEmpty = rom.open(empty.c_str());
+    auto poolMissing = pool.loadROM(CHIP8_ROMS_DIR "/MISSING.ch8");
+    std::filesystem::remove(empty);
+
+    // assert
+    assert(missing == Chip8::RomError::CanNotOpen);
+    assert(emptyFile == Chip8::RomError::Empty);
+    assert(directory == Chip8::RomError::NotAFile);
+    assert(memory.get(Chip8::PROGRAM_START_ADDRESS) == 0);
+    assert(openedEmpty == Chip8::RomError::Empty && rom.data() == nullptr && rom.size() == 0);
+    assert(poolMissing == Chip8::RomError::CanNotOpen);
+}
@@ -0,0 +1,126 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <vector>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/snapshot.h"
+
+struct Frame {
+    Chip8::CpuState state;
+    uint8_t registers[16];
+    uint64_t rows[32];
+};
+
+// Presses a different set of keys every frame, so that games get past their
+// title screens and use their random numbers.
+static uint16_t keysFor(int frame) {
+    return static_cast<uint16_t>((frame * 0x9E37) >> 3);
+}
+
+static std::vector<Frame> run(
+    Chip8::CPU& cpu,
+    Chip8::Registers& registers,
+    const std::shared_ptr<Chip8::Display>& display,
+    const std::shared_ptr<Chip8::Keyboard>& keyboard,
+    const std::shared_ptr<Chip8::Audio>& audio,
+    int from,
+    int frames) {
+    std::vector<Frame> result(frames);
+    for(int frame = 0; frame < frames; frame++) {
+        keyboard->update();
+        keyboard->setState(keysFor(from + frame));
+        cpu.tick(display, keyboard, audio);
+        result[frame].state = cpu.getState();
+        for(uint8_t i = 0; i < 16; i++) {
+            result[frame].registers[i] = registers.get(i);
+        }
+        for(int row = 0; row < 32; row++) {
+            result[frame].rows[row] = display->getRows()[row];
+        }
+    }
+    return result;
+}
+
+static void assertSame(const std::vector<Frame>& expected, const std::vector<Frame>& actual) {
+    assert(expected.size() == actual.size());
+    for(size_t frame = 0; frame < expected.size(); frame++) {
+        assert(expected[frame].state.pc == actual[frame].state.pc);
+        assert(expected[frame].state.index == actual[frame].state.index);
+        assert(expected[frame].state.sp == actual[frame].state.sp);
+        assert(expected[frame].state.delayTimer == actual[frame].state.delayTimer);
+        assert(expected[frame].state.soundTimer == actual[frame].state.soundTimer);
+        assert(expected[frame].state.random == actual[frame].state.random);
+        for(int i = 0; i < 16; i++) {
+            assert(expected[frame].registers[i] == actual[frame].registers[i]);
+        }
+        for(int row = 0; row < 32; row++) {
+            assert(expected[frame].rows[row] == actual[frame].rows[row]);
+        }
+    }
+}
+
+// Saves every bundled ROM halfway through a run, restores it into the same
+// machine and into a fresh one (by way of a file), and checks that both
+// replay the second half exactly.
+int main() {
+    auto path = std::filesystem::temp_directory_path() / "chip8_snapshot_test.sav";
+    for(auto& entry : std::filesystem::recursive_directory_iterator(CHIP8_ROMS_DIR)) {
+        if(entry.path().extension() != ".ch8") {
+            continue;
+        }
+
+        // arrange
+        auto memory = std::make_shared<Chip8::Memory>();
+        auto registers = std::make_shared<Chip8::Registers>();
+        auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+        memory->loadROM(entry.path().c_str());
+        cpu->seedRandom(1);
+        auto display = std::make_shared<Chip8::Display>();
+        auto keyboard = std::make_shared<Chip8::Keyboard>();
+        auto audio = std::make_shared<Chip8::Audio>();
+        run(*cpu, *registers, display, keyboard, audio, 0, 60);
+        auto snapshot = std::make_unique<Chip8::Snapshot>();
+        snapshot->save(*cpu, *display, *keyboard);
+        auto expected = run(*cpu, *registers, display, keyboard, audio, 60, 60);
+
+        auto freshMemory = std::make_shared<Chip8::Memory>();
+        auto freshRegisters = std::make_shared<Chip8::Registers>();
+        auto freshCpu = std::make_shared<Chip8::CPU>(freshMemory, freshRegisters);
+        freshCpu->seedRandom(2);
+        auto freshDisplay = std::make_shared<Chip8::Display>();
+        auto freshKeyboard = std::make_shared<Chip8::Keyboard>();
+        auto written = snapshot->write(path.c_str());
+        auto fromFile = std::make_unique<Chip8::Snapshot>();
+        auto read = fromFile->read(path.c_str());
+
+        // act
+        auto restored = snapshot->restore(*cpu, *display, *keyboard);
+        auto replayed = run(*cpu, *registers, display, keyboard, audio, 60, 60);
+        auto restoredFresh = fromFile->restore(*freshCpu, *freshDisplay, *freshKeyboard);
+        auto replayedFresh = run(*freshCpu, *freshRegisters, freshDisplay, freshKeyboard, audio, 60, 60);
+
+        // assert
+        assert(written);
+        assert(read);
+        assert(restored);
+        assert(restoredFresh);
+        assertSame(expected, replayed);
+        assertSame(expected, replayedFresh);
+    }
+    std::filesystem::remove(path);
+
+    // a snapshot from another version is rejected
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    Chip8::Display display;
+    Chip8::Keyboard keyboard;
+    auto snapshot = std::make_unique<Chip8::Snapshot>();
+    snapshot->save(*cpu, display, keyboard);
+    snapshot->version++;
+    cpu->setDelayTimer(7);
+    auto rejected = !snapshot->restore(*cpu, display, keyboard);
+    assert(rejected);
+    assert(cpu->getDelayTimer() == 7);
+}
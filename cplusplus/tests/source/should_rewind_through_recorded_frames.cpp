@@ -0,0 +1,87 @@
+#include "tests_common.h"
+#include <filesystem>
+#include <vector>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/rewind_buffer.h"
+
+struct Frame {
+    Chip8::CpuState state;
+    uint64_t instructionCount;
+    uint8_t registers[16];
+    uint64_t rows[32];
+};
+
+static Frame capture(Chip8::CPU& cpu, Chip8::Registers& registers, Chip8::Display& display) {
+    Frame frame;
+    frame.state = cpu.getState();
+    frame.instructionCount = cpu.getInstructionCount();
+    for(uint8_t i = 0; i < 16; i++) {
+        frame.registers[i] = registers.get(i);
+    }
+    for(int row = 0; row < 32; row++) {
+        frame.rows[row] = display.getRows()[row];
+    }
+    return frame;
+}
+
+// Records every bundled ROM into a ring too small for the whole run, so
+// that old frames are dropped as it wraps around, then rewinds through
+// everything that is left and compares it with the frames as they were run.
+int main() {
+    for(auto& entry : std::filesystem::recursive_directory_iterator(CHIP8_ROMS_DIR)) {
+        if(entry.path().extension() != ".ch8") {
+            continue;
+        }
+
+        // arrange
+        auto memory = std::make_shared<Chip8::Memory>();
+        auto registers = std::make_shared<Chip8::Registers>();
+        auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+        memory->loadROM(entry.path().c_str());
+        cpu->seedRandom(1);
+        auto display = std::make_shared<Chip8::Display>();
+        auto keyboard = std::make_shared<Chip8::Keyboard>();
+        auto audio = std::make_shared<Chip8::Audio>();
+        Chip8::RewindBuffer rewind(3000);
+        std::vector<Frame> frames;
+        for(int frame = 0; frame < 300; frame++) {
+            keyboard->update();
+            keyboard->setState(static_cast<uint16_t>((frame * 0x9E37) >> 3));
+            cpu->tick(display, keyboard, audio);
+            rewind.record(*cpu, *display, *keyboard);
+            frames.push_back(capture(*cpu, *registers, *display));
+        }
+        auto kept = rewind.getFrames();
+        auto used = rewind.getUsedBytes();
+
+        // act
+        std::vector<Frame> rewound;
+        while(rewind.rewind(*cpu, *display, *keyboard)) {
+            rewound.push_back(capture(*cpu, *registers, *display));
+        }
+
+        // assert
+        assert(kept > 0);
+        assert(kept < frames.size());
+        assert(used <= rewind.getCapacity());
+        assert(rewound.size() == kept);
+        assert(rewind.getFrames() == 0);
+        for(size_t i = 0; i < rewound.size(); i++) {
+            auto& expected = frames[frames.size() - 2 - i];
+            assert(rewound[i].state.pc == expected.state.pc);
+            assert(rewound[i].state.index == expected.state.index);
+            assert(rewound[i].state.sp == expected.state.sp);
+            assert(rewound[i].state.delayTimer == expected.state.delayTimer);
+            assert(rewound[i].state.random == expected.state.random);
+            assert(rewound[i].instructionCount == expected.instructionCount);
+            for(int r = 0; r < 16; r++) {
+                assert(rewound[i].registers[r] == expected.registers[r]);
+            }
+            for(int row = 0; row < 32; row++) {
+                assert(rewound[i].rows[row] == expected.rows[row]);
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include "tests_common.h"
+#include "../include/chip8/batch_cpu.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/timing.h"
+
+static uint64_t run(const uint8_t* program, int length, const Chip8::Timing& timing, bool blocks, bool recompile, int frames) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    for(int i = 0; i < length; i++) {
+        memory->set(0x200 + i, program[i]);
+    }
+    cpu->setTiming(timing);
+    cpu->setBlockExecution(blocks);
+    cpu->setRecompilation(recompile);
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    auto audio = std::make_shared<Chip8::Audio>();
+    for(int frame = 0; frame < frames; frame++) {
+        cpu->tick(display, keyboard, audio);
+    }
+    return cpu->getInstructionCount();
+}
+
+// Counts the instructions a tight loop runs under every timing model, in
+// every way the CPU can run it.
+int main() {
+    // arrange
+    // 0x200: V0 += 1, jump to 0x200
+    const uint8_t loop[] = { 0x70, 0x01, 0x12, 0x00 };
+    // 0x200: wait for a key
+    const uint8_t wait[] = { 0xF0, 0x0A };
+    Chip8::BatchCPU batch(8);
+    for(size_t lane = 0; lane < batch.getSize(); lane++) {
+        for(int i = 0; i < 4; i++) {
+            batch.getMemory(lane).set(0x200 + i, loop[i]);
+        }
+    }
+    batch.setTiming(Chip8::Timing::fixed(600));
+
+    for(int mode = 0; mode < 3; mode++) {
+        auto blocks = mode > 0;
+        auto recompile = mode > 1;
+
+        // act
+        auto vip = run(loop, 4, Chip8::Timing::vip(), blocks, recompile, 1);
+        auto fixed = run(loop, 4, Chip8::Timing::fixed(600), blocks, recompile, 6);
+        auto uneven = run(loop, 4, Chip8::Timing::fixed(700), blocks, recompile, 60);
+        auto unlimited = run(loop, 4, Chip8::Timing::unlimited(), blocks, recompile, 2);
+        auto waitVip = run(wait, 2, Chip8::Timing::vip(), blocks, recompile, 3);
+        auto waitFixed = run(wait, 2, Chip8::Timing::fixed(600), blocks, recompile, 3);
+        auto waitUnlimited = run(wait, 2, Chip8::Timing::unlimited(), blocks, recompile, 3);
+
+        // assert
+        // 111 pairs of 45 + 105 microseconds, and one more 7XNN to overdraw
+        assert(vip == 223);
+        assert(fixed == 60);
+        assert(uneven == 700);
+        assert(unlimited == 2 * Chip8::Timing::UNLIMITED_SLICE);
+        // waiting for a key takes the rest of the frame under every model
+        assert(waitVip == 3);
+        assert(waitFixed == 3);
+        assert(waitUnlimited == 3);
+    }
+
+    // act
+    for(int frame = 0; frame < 6; frame++) {
+        batch.tick();
+    }
+
+    // assert
+    for(size_t lane = 0; lane < batch.getSize(); lane++) {
+        assert(batch.getInstructionCount(lane) == 60);
+    }
+
+    Chip8::Timing vip, fast, rate, parsed;
+    auto parsedVip = Chip8::Timing::parse("vip", vip);
+    auto parsedFast = Chip8::Timing::parse("fast", fast);
+    auto parsedRate = Chip8::Timing::parse("1000", rate);
+    auto parsedZero = Chip8::Timing::parse("0", parsed);
+    auto parsedJunk = Chip8::Timing::parse("10x", parsed);
+    assert(parsedVip && vip == Chip8::Timing::vip());
+    assert(parsedFast && fast == Chip8::Timing::unlimited());
+    assert(parsedRate && rate == Chip8::Timing::fixed(1000));
+    assert(!parsedZero);
+    assert(!parsedJunk);
+}
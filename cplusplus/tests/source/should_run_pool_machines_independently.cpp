@@ -0,0 +1,54 @@
+#include "tests_common.h"
+#include "../include/chip8/emulator_pool.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+
+// Runs more machines than threads, each with its own value in V0, and
+// checks every machine against a CPU run on its own.
+int main() {
+    // arrange
+    const size_t machines = 37;
+    Chip8::EmulatorPool pool(machines, 4);
+    for(size_t i = 0; i < machines; i++) {
+        auto& machine = pool.getMachine(i);
+        machine.memory->set(0x200, 0x60);
+        machine.memory->set(0x201, static_cast<uint8_t>(i));
+        machine.memory->set(0x202, 0x71);
+        machine.memory->set(0x203, 0x01);
+        machine.memory->set(0x204, 0x12);
+        machine.memory->set(0x205, 0x02);
+        machine.keyboard->setKey(i & 0xF, true);
+    }
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    memory->set(0x200, 0x60);
+    memory->set(0x201, 0x00);
+    memory->set(0x202, 0x71);
+    memory->set(0x203, 0x01);
+    memory->set(0x204, 0x12);
+    memory->set(0x205, 0x02);
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    auto audio = std::make_shared<Chip8::Audio>();
+
+    // act
+    pool.runFrames(3);
+    pool.runFrames(2);
+    for(int frame = 0; frame < 5; frame++) {
+        cpu->tick(display, keyboard, audio);
+    }
+
+    // assert
+    assert(pool.getThreadCount() == 4);
+    assert(pool.getInstructionCount() == machines * cpu->getInstructionCount());
+    for(size_t i = 0; i < machines; i++) {
+        auto& machine = pool.getMachine(i);
+        assert(machine.cpu->getPc() == cpu->getPc());
+        assert(machine.cpu->getInstructionCount() == cpu->getInstructionCount());
+        assert(machine.registers->get(0x0) == static_cast<uint8_t>(i));
+        assert(machine.registers->get(0x1) == registers->get(0x1));
+        assert(machine.keyboard->isKeyPressed(i & 0xF));
+    }
+}
@@ -0,0 +1,44 @@
+#include "tests_common.h"
+#include <filesystem>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/quirks.h"
+#include "../include/chip8/snapshot.h"
+
+// Saves an XO-CHIP machine to a file, which holds all 64 KB of its memory,
+// restores it from there and refuses to restore it into a 4 KB machine.
+int main() {
+    // arrange
+    auto path = std::filesystem::temp_directory_path() / "chip8_64k_snapshot_test.snapshot";
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    Chip8::Display display;
+    Chip8::Keyboard keyboard;
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    memory->set(0xC000, 0x42);
+    display.selectPlanes(2);
+
+    // act
+    auto snapshot = std::make_unique<Chip8::Snapshot>();
+    snapshot->save(*cpu, display, keyboard);
+    auto written = snapshot->write(path.c_str());
+    auto fileSize = std::filesystem::file_size(path);
+    auto read = std::make_unique<Chip8::Snapshot>();
+    auto wasRead = read->read(path.c_str());
+    std::filesystem::remove(path);
+    memory->set(0xC000, 0);
+    display.selectPlanes(1);
+    auto restored = read->restore(*cpu, display, keyboard);
+
+    auto smallMemory = std::make_shared<Chip8::Memory>();
+    auto smallCpu = std::make_shared<Chip8::CPU>(smallMemory, std::make_shared<Chip8::Registers>());
+    auto smallRestored = read->restore(*smallCpu, display, keyboard);
+
+    // assert
+    assert(written && wasRead);
+    assert(fileSize == snapshot->getLength());
+    assert(read->ramSize == Chip8::XO_RAM_SIZE);
+    assert(restored && memory->get(0xC000) == 0x42 && display.getSelectedPlanes() == 2);
+    assert(!smallRestored);
+}
@@ -0,0 +1,34 @@
+#include "tests_common.h"
+#include <chrono>
+#include "../include/chip8/frame_pacer.h"
+
+static std::chrono::steady_clock::duration run(Chip8::FramePacer& pacer, uint64_t frames) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t done = 0;
+    while(done < frames) {
+        done += pacer.wait();
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+int main() {
+    // arrange
+    Chip8::FramePacer fast(60);
+    Chip8::FramePacer unlimited(60);
+    fast.setSpeed(4.0);
+    unlimited.setSpeed(Chip8::FramePacer::UNLIMITED);
+
+    // act
+    // frame 0 runs at once, frame 24 is due after 24 / 240 s
+    auto fastTime = run(fast, 25);
+    auto unlimitedTime = run(unlimited, 10000);
+    fast.setSpeed(0.5);
+    auto slowTime = run(fast, 3);
+
+    // assert
+    assert(fastTime >= std::chrono::milliseconds(100));
+    assert(fastTime < std::chrono::milliseconds(400));
+    assert(unlimitedTime < std::chrono::milliseconds(100));
+    assert(slowTime >= std::chrono::milliseconds(99));
+    assert(0 == unlimited.getStats().dropped);
+}
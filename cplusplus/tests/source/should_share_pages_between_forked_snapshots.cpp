@@ -0,0 +1,83 @@
+#include "tests_common.h"
+#include <vector>
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/snapshot_store.h"
+
+// Forks many states from one checkpoint, lets a few of them diverge and
+// checks that only the pages that changed take up new memory, and that
+// every state still restores to what was saved.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    memory->loadROM(CHIP8_ROMS_DIR "/BRIX.ch8");
+    cpu->seedRandom(1);
+    auto display = std::make_shared<Chip8::Display>();
+    auto keyboard = std::make_shared<Chip8::Keyboard>();
+    auto audio = std::make_shared<Chip8::Audio>();
+    for(int frame = 0; frame < 30; frame++) {
+        cpu->tick(display, keyboard, audio);
+    }
+    Chip8::SnapshotStore store;
+    auto root = store.save(*cpu, *display, *keyboard);
+    auto rootPc = cpu->getPc();
+
+    // act
+    std::vector<Chip8::SnapshotStore::Id> forks;
+    for(int i = 0; i < 1000; i++) {
+        forks.push_back(store.fork(root));
+    }
+    auto forked = store.getUsage();
+
+    // one branch writes a byte into a single page
+    store.restore(forks[0], *cpu, *display, *keyboard);
+    memory->set(0xE80, 0x42);
+    auto child = store.save(*cpu, *display, *keyboard, forks[0]);
+    auto branched = store.getUsage();
+
+    // another branch runs on and changes the framebuffer
+    store.restore(forks[1], *cpu, *display, *keyboard);
+    for(int frame = 0; frame < 30; frame++) {
+        cpu->tick(display, keyboard, audio);
+    }
+    auto later = store.save(*cpu, *display, *keyboard, forks[1]);
+    auto laterPc = cpu->getPc();
+    auto laterRow = display->getRows()[31];
+
+    store.restore(child, *cpu, *display, *keyboard);
+    auto childByte = memory->get(0xE80);
+    store.restore(root, *cpu, *display, *keyboard);
+    auto restoredPc = cpu->getPc();
+    auto rootByte = memory->get(0xE80);
+    store.restore(later, *cpu, *display, *keyboard);
+    auto restoredLaterPc = cpu->getPc();
+    auto restoredLaterRow = display->getRows()[31];
+
+    for(auto fork : forks) {
+        store.release(fork);
+    }
+    store.release(child);
+    store.release(later);
+    auto rootOnly = store.getUsage();
+    store.release(root);
+    auto empty = store.getUsage();
+
+    // assert
+    assert(forked.states == 1001);
+    assert(forked.pages == Chip8::SnapshotStore::PAGES);
+    assert(forked.bytes < forked.flatBytes / 10);
+    assert(branched.pages == Chip8::SnapshotStore::PAGES + 1);
+    assert(childByte == 0x42);
+    assert(rootByte != 0x42);
+    assert(restoredPc == rootPc);
+    assert(restoredLaterPc == laterPc);
+    assert(restoredLaterRow == laterRow);
+    assert(rootOnly.states == 1);
+    assert(rootOnly.pages == Chip8::SnapshotStore::PAGES);
+    assert(empty.states == 0);
+    assert(empty.pages == 0);
+    assert(!store.isLive(root));
+}
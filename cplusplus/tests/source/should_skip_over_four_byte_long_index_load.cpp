@@ -0,0 +1,64 @@
+#include "tests_common.h"
+#include "../include/chip8/batch_cpu.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/audio.h"
+#include "../include/chip8/quirks.h"
+
+// 0x200: I = 0x8000, V1 = 4, V3 = 1
+// 0x208: V2 += 1, skip F000 6155, whose address sets V1 if it runs as an
+//        instruction, loop
+static uint8_t PROGRAM[] = {
+    0xF0, 0x00, 0x80, 0x00, 0x61, 0x04, 0x63, 0x01,
+    0x72, 0x01, 0x33, 0x01, 0xF0, 0x00, 0x61, 0x55, 0x12, 0x08
+};
+
+static bool skipped(uint8_t v1, uint16_t index) {
+    return v1 == 4 && index == 0x8000;
+}
+
+static bool tick(bool blocks, bool recompile) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    memory->load(0x200, PROGRAM, sizeof(PROGRAM));
+    cpu->setBlockExecution(blocks);
+    cpu->setRecompilation(recompile);
+    cpu->tick(std::make_shared<Chip8::Display>(), std::make_shared<Chip8::Keyboard>(), std::make_shared<Chip8::Audio>());
+    return skipped(registers->get(1), cpu->getIndex());
+}
+
+// Skips jump over all four bytes of F000 NNNN, however the CPU runs them.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    memory->load(0x200, PROGRAM, sizeof(PROGRAM));
+    Chip8::BatchCPU batch(4);
+    batch.setQuirks(Chip8::Quirks::xoChip());
+    for(size_t lane = 0; lane < batch.getSize(); lane++) {
+        batch.getMemory(lane).load(0x200, PROGRAM, sizeof(PROGRAM));
+    }
+
+    // act
+    for(int i = 0; i < 20; i++) {
+        cpu->emulateCycle(nullptr, nullptr);
+    }
+    auto stepped = skipped(registers->get(1), cpu->getIndex());
+    auto interpreted = tick(false, false);
+    auto blocks = tick(true, false);
+    auto recompiled = tick(true, true);
+    batch.tick();
+
+    // assert
+    assert(stepped);
+    assert(interpreted);
+    assert(blocks);
+    assert(recompiled);
+    for(size_t lane = 0; lane < batch.getSize(); lane++) {
+        assert(skipped(batch.getRegister(lane, 1), batch.getIndex(lane)));
+    }
+}
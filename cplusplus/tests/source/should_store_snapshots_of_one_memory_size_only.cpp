@@ -0,0 +1,33 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/keyboard.h"
+#include "../include/chip8/quirks.h"
+#include "../include/chip8/snapshot_store.h"
+
+// A store that holds an XO-CHIP machine pages all 64 KB of it and turns
+// away a 4 KB machine.
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, std::make_shared<Chip8::Registers>());
+    auto smallMemory = std::make_shared<Chip8::Memory>();
+    auto smallCpu = std::make_shared<Chip8::CPU>(smallMemory, std::make_shared<Chip8::Registers>());
+    Chip8::Display display;
+    Chip8::Keyboard keyboard;
+    cpu->setQuirks(Chip8::Quirks::xoChip());
+    memory->set(0xC000, 0x42);
+    Chip8::SnapshotStore store;
+
+    // act
+    auto stored = store.save(*cpu, display, keyboard);
+    auto usage = store.getUsage();
+    memory->set(0xC000, 0);
+    store.restore(stored, *cpu, display, keyboard);
+    auto smallStored = store.save(*smallCpu, display, keyboard);
+
+    // assert
+    assert(stored != Chip8::SnapshotStore::NONE);
+    assert(usage.pages == Chip8::SnapshotStore::FRAME_PAGES + Chip8::XO_RAM_SIZE / Chip8::SnapshotStore::PAGE_SIZE);
+    assert(memory->get(0xC000) == 0x42);
+    assert(smallStored == Chip8::SnapshotStore::NONE);
+}
@@ -0,0 +1,35 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+
+// Draws the font character 0 (a 4x5 box) two pixels left of the bottom
+// right corner, so that it crosses both edges.
+static std::shared_ptr<Chip8::Display> draw(Chip8::SpriteEdge edge) {
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    auto display = std::make_shared<Chip8::Display>();
+    cpu->setSpriteEdge(edge);
+    uint8_t data[] = { 0x60, 0x3E, 0x61, 0x1E, 0xA0, 0x00, 0xD0, 0x15 };
+    memory->load(512, data, sizeof(data));
+    for(int i = 0; i < 4; i++) {
+        cpu->emulateCycle(display, nullptr);
+    }
+    return display;
+}
+
+int main() {
+    // act
+    auto clipped = draw(Chip8::SpriteEdge::Clip);
+    auto wrapped = draw(Chip8::SpriteEdge::Wrap);
+
+    // assert
+    assert(0x3 == clipped->getRows()[30]);
+    assert(0x2 == clipped->getRows()[31]);
+    assert(0 == clipped->getRows()[0]);
+    assert((0xC000000000000003 == wrapped->getRows()[30]));
+    assert((0x4000000000000002 == wrapped->getRows()[31]));
+    assert((0x4000000000000002 == wrapped->getRows()[0]));
+    assert((0x4000000000000002 == wrapped->getRows()[1]));
+    assert((0xC000000000000003 == wrapped->getRows()[2]));
+    assert(wrapped->getPixel(63, 30) && !wrapped->getPixel(61, 30));
+}
@@ -0,0 +1,29 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+
+int main() {
+    // arrange
+    auto memory = std::make_shared<Chip8::Memory>();
+    auto registers = std::make_shared<Chip8::Registers>();
+    auto cpu = std::make_shared<Chip8::CPU>(memory, registers);
+    auto display = std::make_shared<Chip8::Display>();
+    // draw the font character 0 at (3, 2) twice
+    uint8_t data[] = { 0x60, 0x03, 0x61, 0x02, 0xA0, 0x00, 0xD0, 0x15, 0xD0, 0x15 };
+    memory->load(512, data, sizeof(data));
+
+    // act
+    for(int i = 0; i < 4; i++) {
+        cpu->emulateCycle(display, nullptr);
+    }
+    auto firstFlag = registers->get(0xF);
+    auto firstRow = display->getRows()[2];
+    cpu->emulateCycle(display, nullptr);
+
+    // assert
+    assert(0 == firstFlag);
+    assert((uint64_t(0xF0) << 53) == firstRow);
+    assert(1 == registers->get(0xF));
+    for(int row = 0; row < 32; row++) {
+        assert(0 == display->getRows()[row]);
+    }
+}
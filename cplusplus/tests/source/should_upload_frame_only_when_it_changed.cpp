@@ -0,0 +1,33 @@
+#include "tests_common.h"
+#include "../include/chip8/display.h"
+#include "../include/chip8/renderer.h"
+
+int main() {
+    // arrange
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    auto sdlInitialized = SDL_Init(SDL_INIT_VIDEO) == 0;
+    Chip8::Palette palette = { 0xFF102030, 0xFFC0D0E0 };
+    auto renderer = std::make_unique<Chip8::Renderer>(2, palette);
+    auto rendererInitialized = renderer->init();
+    Chip8::Display display;
+    uint8_t sprite[] = { 0x80 };
+
+    // act
+    renderer->present(display.getPlanes());
+    renderer->present(display.getPlanes());
+    auto uploadsOfBlankFrame = renderer->getUploadCount();
+    display.drawSprite(5, 7, sprite, 1, Chip8::SpriteEdge::Clip);
+    renderer->present(display.getPlanes());
+    renderer->present(display.getPlanes());
+
+    // assert
+    assert(sdlInitialized);
+    assert(rendererInitialized);
+    assert(1 == uploadsOfBlankFrame);
+    assert(2 == renderer->getUploadCount());
+    assert(0xFFC0D0E0 == renderer->getPixels()[7 * 64 + 5]);
+    assert(0xFF102030 == renderer->getPixels()[7 * 64 + 6]);
+
+    renderer.reset();
+    SDL_Quit();
+}